@@ -2,176 +2,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
-
-struct SpectrumRenderData
-{
-    std::vector<float> spectrumPath;
-    std::vector<float> peakHoldPath;
-    float leftDB = -100.0f;
-    float rightDB = -100.0f;
-};
-
-class PathProducer
-{
-public:
-    PathProducer(SingleChannelSampleFifo& leftScsf, SingleChannelSampleFifo& rightScsf): leftChannelFifo(&leftScsf), rightChannelFifo(&rightScsf)
-    {
-        fftBuffer.setSize(1, FFT_OUT_SIZE, false, true, true);
-        monoBufferL.setSize(1, FFT_SIZE, false, true, true);
-        monoBufferR.setSize(1, FFT_SIZE, false, true, true);
-        monoAverageBuffer.setSize(1, FFT_SIZE, false, true, true);
-        peakFallVelocity.assign(RENDER_OUT_SIZE, 0.0f);
-        peakHoldDecibels.assign(RENDER_OUT_SIZE, -std::numeric_limits<float>::infinity());
-        currentDecibels.assign(RENDER_OUT_SIZE, -std::numeric_limits<float>::infinity());
-        Gains.assign(RENDER_OUT_SIZE, 0.0f);
-        SmoothGains.assign(RENDER_OUT_SIZE, 0.0f);
-    };
-    void process(double sampleRate)
-    {
-        juce::AudioBuffer<float> leftIncomingBuffer, rightIncomingBuffer;
-        bool aaa = false;
-        while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0 && rightChannelFifo->getNumCompleteBuffersAvailable() > 0)
-        {
-            if (leftChannelFifo->getAudioBuffer(leftIncomingBuffer) && rightChannelFifo->getAudioBuffer(rightIncomingBuffer))
-            {
-                aaa = true;
-                const int incomingSize = leftIncomingBuffer.getNumSamples();
-                currentLeftGain = leftIncomingBuffer.getMagnitude(0, 0, incomingSize);
-                currentRightGain = rightIncomingBuffer.getMagnitude(0, 0, incomingSize);
-                const int copySize = FFT_SIZE - incomingSize;
-                monoBufferL.copyFrom(0, 0, monoBufferL.getReadPointer(0, incomingSize), copySize);
-                monoBufferR.copyFrom(0, 0, monoBufferR.getReadPointer(0, incomingSize), copySize);
-                monoBufferL.copyFrom(0, copySize, leftIncomingBuffer.getReadPointer(0), incomingSize);
-                monoBufferR.copyFrom(0, copySize, rightIncomingBuffer.getReadPointer(0), incomingSize);
-                auto* destData = monoAverageBuffer.getWritePointer(0);
-                juce::FloatVectorOperations::copy(destData, monoBufferL.getReadPointer(0), FFT_SIZE);
-                juce::FloatVectorOperations::add(destData, monoBufferR.getReadPointer(0), FFT_SIZE);
-                juce::FloatVectorOperations::multiply(destData, 0.5f, FFT_SIZE);
-                auto* fftDataWritePointer = fftBuffer.getWritePointer(0);
-                juce::FloatVectorOperations::clear(fftDataWritePointer, FFT_OUT_SIZE);
-                juce::FloatVectorOperations::copy(fftDataWritePointer, monoAverageBuffer.getReadPointer(0), FFT_SIZE);
-                windowing.multiplyWithWindowingTable(fftDataWritePointer, FFT_SIZE);
-                fft.performFrequencyOnlyForwardTransform(fftDataWritePointer);
-                juce::FloatVectorOperations::multiply(fftDataWritePointer, fftDataWritePointer, INVERSE_NUM_BINS, NUM_BINS);
-                generatePath(fftDataWritePointer, static_cast<float>(incomingSize) / sampleRate);
-            }
-        }
-        if (aaa)
-        {
-            pathFifo.push({currentDecibels, peakHoldDecibels, juce::Decibels::gainToDecibels(smoothedLeftGain), juce::Decibels::gainToDecibels(smoothedRightGain)});
-        }
-    };
-    int getNumPathsAvailable() const
-    {
-        return pathFifo.getNumAvailableForReading();
-    }
-    ;
-    bool getPath(SpectrumRenderData& path)
-    {
-        return pathFifo.pull(path);
-    };
-    std::vector<float> makeFreqLUT(const double sampleRate, const float minHz, const float maxHz) const
-    {
-        std::vector<float> frequencyLUT;
-        frequencyLUT.reserve(RENDER_OUT_SIZE);
-        const float binWidth = static_cast<float>(sampleRate / FFT_SIZE);
-        for (int levelIndex = 0, sourceDataIndex = 0, outputIndex = 0; levelIndex < NUM_SECTIONS; ++levelIndex)
-        {
-            const int windowSize = 1 << levelIndex;
-            const int nextOutputStart = outputIndex + (SECTION_SIZE >> levelIndex);
-            for (; outputIndex < nextOutputStart; ++outputIndex)
-            {
-
-                frequencyLUT.push_back(juce::mapFromLog10((binWidth * sourceDataIndex), minHz, maxHz));
-                sourceDataIndex += windowSize;
-            }
-        }
-        return frequencyLUT;
-    };
-private:
-    static constexpr int FFT_ORDER = 12;
-    static constexpr int NUM_SECTIONS = 1 << 3;
-    static constexpr int SECTION_SIZE = 1 << 8;
-    static constexpr int NUM_BINS = 1 << (FFT_ORDER - 1);
-    static constexpr int FFT_SIZE = 1 << FFT_ORDER;
-    static constexpr int FFT_OUT_SIZE = 1 << (FFT_ORDER + 1);
-    static constexpr int RENDER_OUT_SIZE = 510;
-    static constexpr float INVERSE_NUM_BINS = 1.0f / (1 << (FFT_ORDER - 1));
-    static constexpr float SMOOTHING_TIME_CONSTANT = 0.02f;
-    static constexpr float PEAK_DECAY_RATE = 80.0f;
-    static constexpr float LEVEL_METER_SMOOTHING_TIME_CONSTANT = SMOOTHING_TIME_CONSTANT * 5.0f;
-    SingleChannelSampleFifo* leftChannelFifo;
-    SingleChannelSampleFifo* rightChannelFifo;
-    juce::AudioBuffer<float> monoBufferL;
-    juce::AudioBuffer<float> monoBufferR;
-    juce::AudioBuffer<float> fftBuffer;
-    juce::AudioBuffer<float> monoAverageBuffer;
-    juce::dsp::FFT fft {FFT_ORDER};
-    juce::dsp::WindowingFunction<float> windowing {size_t(FFT_SIZE), juce::dsp::WindowingFunction<float>::blackmanHarris, true};
-    std::vector<float> peakFallVelocity;
-    std::vector<float> peakHoldDecibels;
-    std::vector<float> Gains;
-    std::vector<float> SmoothGains;
-    std::vector<float> currentDecibels;
-    float currentLeftGain = 0.0f;
-    float currentRightGain = 0.0f;
-    float smoothedLeftGain = 0.0f;
-    float smoothedRightGain = 0.0f;
-    Fifo<SpectrumRenderData> pathFifo;
-    void generatePath(const float* renderData, const float deltaTime)
-    {
-        for (int levelIndex = 0, sourceDataIndex = 0, outputIndex = 0; levelIndex < NUM_SECTIONS; ++levelIndex)
-        {
-            const int windowSize = 1 << levelIndex;
-            const int nextOutputStart = outputIndex + (SECTION_SIZE >> levelIndex);
-            for (; outputIndex < nextOutputStart; ++outputIndex)
-            {
-                Gains[outputIndex] = *std::max_element(renderData + sourceDataIndex, renderData + sourceDataIndex + windowSize);
-                sourceDataIndex += windowSize;
-            }
-        }
-        const float peakFallRate = PEAK_DECAY_RATE * deltaTime;
-        const float alphaSmooth = 1.0f - std::exp(-deltaTime / SMOOTHING_TIME_CONSTANT);
-        const float oneMinusAlpha = 1.0f - alphaSmooth;
-        for (size_t i = 0; i < RENDER_OUT_SIZE; ++i)
-        {
-            if (SmoothGains[i] > Gains[i])
-            {
-                SmoothGains[i] = alphaSmooth * Gains[i] + oneMinusAlpha * SmoothGains[i];
-            }
-            else
-            {
-                SmoothGains[i] = Gains[i];
-            }
-            currentDecibels[i] = juce::Decibels::gainToDecibels(SmoothGains[i]);
-            peakFallVelocity[i] += peakFallRate;
-            peakHoldDecibels[i] -= peakFallVelocity[i] * deltaTime;
-            if (currentDecibels[i] >= peakHoldDecibels[i])
-            {
-                peakFallVelocity[i] = 0.0f;
-                peakHoldDecibels[i] = currentDecibels[i];
-            }
-        }
-        const float levelMeterAlphaSmooth = 1.0f - std::exp(-deltaTime / (LEVEL_METER_SMOOTHING_TIME_CONSTANT));
-        const float levelMeterOneMinusAlpha = 1.0f - levelMeterAlphaSmooth;
-        if (currentLeftGain < smoothedLeftGain)
-        {
-            smoothedLeftGain = levelMeterAlphaSmooth * currentLeftGain + levelMeterOneMinusAlpha * smoothedLeftGain;
-        }
-        else
-        {
-            smoothedLeftGain = currentLeftGain;
-        }
-        if (currentRightGain < smoothedRightGain)
-        {
-            smoothedRightGain = levelMeterAlphaSmooth * currentRightGain + levelMeterOneMinusAlpha * smoothedRightGain;
-        }
-        else
-        {
-            smoothedRightGain = currentRightGain;
-        }
-    };
-};
+#include "QSpectrogram.h"
+#include "QRenderCache.h"
 
 namespace quasar
 {
@@ -186,42 +18,71 @@ namespace quasar
     }
 }
 
-class VisualizerComponent: public juce::Component, private juce::AsyncUpdater, public juce::AudioProcessorValueTreeState::Listener
+struct SharedEditorResources
 {
-public:
-    VisualizerComponent(QuasarEQAudioProcessor& p):
-        audioProcessor(p),
-        pathProducer(audioProcessor.leftChannelFifo, audioProcessor.rightChannelFifo),
-        analyzerThread(pathProducer, *this)
+    SharedEditorResources()
     {
-        freqLUT = pathProducer.makeFreqLUT(audioProcessor.getSampleRate(), MIN_HZ, MAX_HZ);
-        for (int i = 0; i < NUM_BANDS; ++i)
+        for (auto freq : gridMarkers)
         {
-            const juce::String index = juce::String (i + 1);
-            for (const auto& prefix : bandParamPrefixes)
-            {
-                audioProcessor.apvts.addParameterListener (prefix + index, this);
-            }
+            gridMarkerLabels.add(freq < 1000.0f ? juce::String(static_cast<int>(freq)) : juce::String(static_cast<int>(freq / 1000.0f)) + "k");
         }
-    };
-    ~VisualizerComponent()
-    {
         for (int i = 0; i < NUM_BANDS; ++i)
         {
-            const juce::String index = juce::String (i + 1);
-            for (const auto& prefix : bandParamPrefixes)
-            {
-                audioProcessor.apvts.removeParameterListener (prefix + index, this);
-            }
+            bandLabels.add(juce::String(i + 1));
         }
     };
-    void parameterChanged(const juce::String& parameterID, float newValue)
+    static inline const std::array<float, 10> gridMarkers {20.0f, 50.0f, 100.0f, 200.0f, 500.0f, 1000.0f, 2000.0f, 5000.0f, 10000.0f, 20000.0f};
+    static inline const juce::StringArray dbTags {"+24", "+18", "+12", "+6", "0", "-6", "-12", "-18", "-24"};
+    static inline const juce::StringArray meterTags {"+6", "+3", "0", "-3", "-6", "-9", "-12", "-15", "-18"};
+    static constexpr int HALF_FONT_HEIGHT = 5;
+    static constexpr int FONT_HEIGHT = HALF_FONT_HEIGHT * 2;
+    static constexpr int BAND_LABEL_HEIGHT = 12;
+    static constexpr int GRID_CACHE_CAPACITY = 8;
+    juce::StringArray gridMarkerLabels;
+    juce::StringArray bandLabels;
+    TextWidthCache gridLabelWidths {juce::Font(static_cast<float>(FONT_HEIGHT))};
+    TextWidthCache bandLabelWidths {juce::Font(static_cast<float>(BAND_LABEL_HEIGHT))};
+    ScaledImageCache<GRID_CACHE_CAPACITY> gridCaches;
+};
+
+class VisualizerComponent: public juce::Component, private juce::AsyncUpdater, private juce::Timer, private AnalyzerJob::Client
+{
+public:
+    VisualizerComponent(QuasarEQAudioProcessor& p):
+        audioProcessor(p),
+        analyzerJob(audioProcessor.getAnalyzerJob()),
+        coefficientCache(audioProcessor.getCoefficientCache())
+    {
+    };
+    ~VisualizerComponent() override
     {
-        parametersNeedUpdate = true;
+        commitPendingEdit();
+        analyzerJob.setClient(nullptr);
+    };
+    void attachSpectrogram(SpectrogramComponent* s)
+    {
+        spectrogram = s;
+        if (spectrogram != nullptr && !freqLUT.empty())
+        {
+            spectrogram->setFrequencyMapping(freqLUT);
+        }
     };
     void paint(juce::Graphics& g) override
     {
-        g.drawImageAt(gridCache, 0, 0);
+        if (!analyzerStarted)
+        {
+            startAnalyzer();
+        }
+        const float physicalScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        if (physicalScale != displayScale)
+        {
+            displayScale = physicalScale;
+            refreshGridCache();
+        }
+        if (gridImage.isValid())
+        {
+            g.drawImage(gridImage, getLocalBounds().toFloat());
+        }
         SpectrumRenderData localPath;
         {
             juce::ScopedLock lock(pathLock);
@@ -293,10 +154,10 @@ public:
                 g.fillEllipse(x - (pointSize >> 1), y - pointSize * 0.5f, pointSize, pointSize);
                 g.setColour(quasar::colours::staticText);
                 g.drawEllipse(x - (pointSize >> 1), y - pointSize * 0.5f, pointSize, pointSize, 1.5f);
-                juce::String bandNumber = juce::String(i + 1);
-                const int textHeight = 12;
-                g.setFont(textHeight);
-                const int textWidth = g.getCurrentFont().getStringWidth(bandNumber);
+                const juce::String& bandNumber = sharedResources->bandLabels[i];
+                const int textHeight = SharedEditorResources::BAND_LABEL_HEIGHT;
+                g.setFont(sharedResources->bandLabelWidths.getFont());
+                const int textWidth = sharedResources->bandLabelWidths.getStringWidth(bandNumber);
                 juce::Rectangle<int> textBounds(juce::roundToInt(x - textWidth * 0.5f), y - 6, textWidth, textHeight);
                 g.drawText(bandNumber, textBounds, juce::Justification::centred, false);
             }
@@ -335,6 +196,7 @@ public:
     {
         if (draggingBand != -1)
         {
+            commitPendingEdit();
             juce::String index = juce::String(draggingBand + 1);
             if (auto* p1 = audioProcessor.apvts.getParameter("Freq" + index)) p1->endChangeGesture();
             if (auto* p2 = audioProcessor.apvts.getParameter("Gain" + index)) p2->endChangeGesture();
@@ -347,19 +209,21 @@ public:
         if (bandIdx == -1) return;
         const juce::String index = juce::String(bandIdx + 1);
         const juce::String paramID = "Q" + index;
-        if (auto* qParam = audioProcessor.apvts.getParameter(paramID))
+        if (audioProcessor.apvts.getParameter(paramID) != nullptr)
         {
-            float currentRealValue = audioProcessor.apvts.getRawParameterValue(paramID)->load();
-            float currentNormalized = qParam->getValue();
-            float newNormalized = juce::jlimit(0.0f, 1.0f, currentNormalized + (wheel.deltaY * 0.1f));
+            auto& edit = getPendingEdit(bandIdx);
             auto range = audioProcessor.apvts.getParameterRange(paramID);
+            float currentRealValue = edit.quality ? edit.q : audioProcessor.apvts.getRawParameterValue(paramID)->load();
+            float currentNormalized = range.convertTo0to1(currentRealValue);
+            float newNormalized = juce::jlimit(0.0f, 1.0f, currentNormalized + (wheel.deltaY * 0.1f));
             float newRealValue = range.snapToLegalValue(range.convertFrom0to1(newNormalized));
             if (newRealValue == currentRealValue && wheel.deltaY != 0)
             {
                 float direction = (wheel.deltaY > 0) ? 1.0f : -1.0f;
                 newRealValue = currentRealValue + (0.001f * direction);
             }
-            qParam->setValueNotifyingHost(range.convertTo0to1(newRealValue));
+            edit.q = newRealValue;
+            edit.quality = true;
         }
     }
 private:
@@ -394,29 +258,99 @@ private:
         float freqHz = juce::mapToLog10(juce::jlimit(0.0f, 1.0f, normalizedX), MIN_HZ, MAX_HZ);
         float gainDb = juce::jmap(mousePos.getY(), bounds.getBottom(), bounds.getY(), minDb, maxDb);
         gainDb = juce::jlimit(minDb, maxDb, gainDb);
-        juce::String index = juce::String(draggingBand + 1);
-        if (auto* freqParam = audioProcessor.apvts.getParameter("Freq" + index))
-            freqParam->setValueNotifyingHost(audioProcessor.apvts.getParameterRange("Freq" + index).convertTo0to1(freqHz));
-        if (auto* gainParam = audioProcessor.apvts.getParameter("Gain" + index))
-            gainParam->setValueNotifyingHost(audioProcessor.apvts.getParameterRange("Gain" + index).convertTo0to1(gainDb));
+        auto& edit = getPendingEdit(draggingBand);
+        edit.freq = freqHz;
+        edit.gain = gainDb;
+        edit.position = true;
+    }
+    int pendingBand = -1;
+    BandEdit pendingEdit;
+    juce::VBlankAttachment vBlankAttachment {this, [this] { commitPendingEdit(); }};
+    BandEdit& getPendingEdit(int band)
+    {
+        if (band != pendingBand)
+        {
+            commitPendingEdit();
+            pendingBand = band;
+        }
+        return pendingEdit;
+    }
+    void commitPendingEdit()
+    {
+        if (pendingBand == -1)
+        {
+            return;
+        }
+        audioProcessor.commitBandEdit(pendingBand, pendingEdit);
+        pendingBand = -1;
+        pendingEdit = {};
     }
 
-    bool parametersNeedUpdate = true;
+    std::atomic<uint32_t> drawnParameterVersion {0};
+    std::atomic<uint32_t> analyzerConfigVersion {std::numeric_limits<uint32_t>::max()};
+    AnalyzerConfig analyzerConfig;
+    void startAnalyzer()
+    {
+        applyAnalyzerConfig(audioProcessor.getAnalyzerConfig());
+        analyzerJob.setClient(this);
+        analyzerJob.setVisible(isShowing());
+        analyzerStarted = true;
+    };
+    void visibilityChanged() override
+    {
+        if (analyzerStarted)
+        {
+            analyzerJob.setVisible(isShowing());
+        }
+    };
+    void analyzerJobFinished() override
+    {
+        const bool parametersChanged = audioProcessor.getParameterVersion() != drawnParameterVersion;
+        const bool configChanged = audioProcessor.getAnalyzerConfig().version != analyzerConfigVersion;
+        if (!isUpdatePending() && (analyzerJob.getPathProducer().getNumPathsAvailable() > 0 || parametersChanged || configChanged))
+        {
+            triggerAsyncUpdate();
+        }
+    };
+    void applyAnalyzerConfig(const AnalyzerConfig& config)
+    {
+        analyzerConfig = config;
+        freqLUT = analyzerJob.getPathProducer().makeFreqLUT(config.sampleRate, MIN_HZ, MAX_HZ);
+        if (spectrogram != nullptr)
+        {
+            spectrogram->setFrequencyMapping(freqLUT);
+        }
+        calculateResponseCurve();
+        analyzerConfigVersion = config.version;
+    };
     void handleAsyncUpdate() override
     {
+        const auto config = audioProcessor.getAnalyzerConfig();
+        if (config.version != analyzerConfigVersion)
+        {
+            applyAnalyzerConfig(config);
+            repaint();
+        }
         SpectrumRenderData path;
         bool newPathAvailable = false;
+        auto& pathProducer = analyzerJob.getPathProducer();
         while (pathProducer.getNumPathsAvailable() > 0)
         {
             if (pathProducer.getPath(path))
             {
                 newPathAvailable = true;
+                if (spectrogram != nullptr)
+                {
+                    spectrogram->pushFrame(path.spectrumPath);
+                }
             }
         }
-        if (parametersNeedUpdate)
+        const uint32_t parameterVersion = audioProcessor.getParameterVersion();
+        if (parameterVersion != drawnParameterVersion)
         {
+            drawnParameterVersion = parameterVersion;
             calculateResponseCurve();
-            parametersNeedUpdate = false;
+            repaint();
         }
         if (newPathAvailable)
         {
@@ -429,8 +363,48 @@ private:
     };
     void resized() override
     {
-        gridCache = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
-        juce::Graphics g(gridCache);
+        refreshGridCache();
+        calculateResponseCurve();
+    };
+    void timerCallback() override
+    {
+        stopTimer();
+        const RenderCacheKey key {getWidth(), getHeight(), displayScale};
+        if (const auto* cached = sharedResources->gridCaches.find(key))
+        {
+            gridImage = *cached;
+        }
+        else
+        {
+            gridImage = sharedResources->gridCaches.insert(key, renderGridCache(key));
+        }
+        repaint();
+    };
+    void refreshGridCache()
+    {
+        const RenderCacheKey key {getWidth(), getHeight(), displayScale};
+        if (key.isEmpty())
+        {
+            return;
+        }
+        if (const auto* cached = sharedResources->gridCaches.find(key))
+        {
+            stopTimer();
+            gridImage = *cached;
+            return;
+        }
+        if (!gridImage.isValid())
+        {
+            gridImage = sharedResources->gridCaches.insert(key, renderGridCache(key));
+            return;
+        }
+        startTimer(RESIZE_SETTLE_TIME);
+    };
+    juce::Image renderGridCache(const RenderCacheKey& key)
+    {
+        juce::Image image(juce::Image::ARGB, juce::roundToInt(key.width * key.scale), juce::roundToInt(key.height * key.scale), true);
+        juce::Graphics g(image);
+        g.addTransform(juce::AffineTransform::scale(key.scale));
         g.setColour(juce::Colours::black);
         g.fillRect(getCurveArea());
         g.fillRect(getLevelMeterArea());
@@ -438,6 +412,10 @@ private:
         g.drawRect(getLevelMeterArea());
         g.drawHorizontalLine(getLevelMeterArea().getY() + getLevelMeterArea().getHeight() * (0.25f), getLevelMeterArea().getX(), getLevelMeterArea().getRight());
         g.drawVerticalLine(getLevelMeterArea().getCentreX(), getLevelMeterArea().getY(), getLevelMeterArea().getBottom());
+        const auto& gridMarkers = SharedEditorResources::gridMarkers;
+        const auto& dbTags = SharedEditorResources::dbTags;
+        const auto& meterTags = SharedEditorResources::meterTags;
+        auto& gridLabelWidths = sharedResources->gridLabelWidths;
         std::vector<float> gridLUTX;
         std::vector<float> gridLUTY;
         for (auto freq : gridMarkers)
@@ -457,25 +435,27 @@ private:
             g.drawHorizontalLine(y, getCurveArea().toFloat().getX(), getCurveArea().toFloat().getRight());
         }
         g.setColour(quasar::colours::staticText);
-        g.setFont(FONT_HEIGHT);
+        g.setFont(gridLabelWidths.getFont());
         const int freqLabelY = getCurveArea().getBottom() + margin - HALF_FONT_HEIGHT;
         for (size_t i = 0; i < gridLUTX.size(); ++i)
         {
-            auto string = getGridMarkerLabel(gridMarkers[i]);
-            const int stringWidth = g.getCurrentFont().getStringWidth(string);
+            const juce::String& string = sharedResources->gridMarkerLabels[static_cast<int>(i)];
+            const int stringWidth = gridLabelWidths.getStringWidth(string);
             const int labelX = static_cast<int>(std::roundf(gridLUTX[i] - stringWidth * 0.5f));
             g.drawText(string, labelX, freqLabelY, stringWidth, FONT_HEIGHT, juce::Justification::centred, false);
         }
         for (size_t i = 0; i < gridLUTY.size(); ++i)
         {
             const int dbLabelY = static_cast<int>(std::roundf(gridLUTY[i] - HALF_FONT_HEIGHT));
-            const int curveLabelWidth = g.getCurrentFont().getStringWidth(dbTags[i]);
+            const int tagIndex = static_cast<int>(i);
+            const int curveLabelWidth = gridLabelWidths.getStringWidth(dbTags[tagIndex]);
             const int curveLabelY = getCurveArea().getX() - margin - static_cast<int>(std::roundf(curveLabelWidth * 0.5f));
-            g.drawText(dbTags[i], curveLabelY, dbLabelY, curveLabelWidth, FONT_HEIGHT, juce::Justification::centred, false);
-            const int meterLabelWidth = g.getCurrentFont().getStringWidth(meterTags[i]);
+            g.drawText(dbTags[tagIndex], curveLabelY, dbLabelY, curveLabelWidth, FONT_HEIGHT, juce::Justification::centred, false);
+            const int meterLabelWidth = gridLabelWidths.getStringWidth(meterTags[tagIndex]);
             const int meterLabelY = getLevelMeterArea().getX() - margin - static_cast<int>(std::roundf(meterLabelWidth * 0.5f));
-            g.drawText(meterTags[i], meterLabelY, dbLabelY, meterLabelWidth, FONT_HEIGHT, juce::Justification::centred, false);
+            g.drawText(meterTags[tagIndex], meterLabelY, dbLabelY, meterLabelWidth, FONT_HEIGHT, juce::Justification::centred, false);
         }
+        return image;
     };
     juce::Rectangle<int> getLevelMeterArea()
     {
@@ -522,13 +502,22 @@ private:
     void calculateResponseCurve()
     {
         const int curveSize = getCurveArea().getWidth();
-        const float minHz = MIN_HZ;
-        const float maxHz = MAX_HZ;
-        double sr = audioProcessor.getSampleRate();
-        responseCurveMagnitude.clear();
-        responseCurveMagnitude.resize(curveSize, 0.0f);
-        using T = float;
-        std::vector<juce::dsp::IIR::Coefficients<T>::Ptr> coefsBuffer;
+        if (curveSize < 2)
+        {
+            return;
+        }
+        const double sr = analyzerConfig.sampleRate;
+        if (responseModel.getNumPoints() != curveSize || responseModelSampleRate != sr)
+        {
+            std::vector<float> frequencies(static_cast<size_t>(curveSize));
+            for (int i = 0; i < curveSize; ++i)
+            {
+                frequencies[static_cast<size_t>(i)] = juce::mapToLog10(static_cast<float>(i) / static_cast<float>(curveSize - 1), MIN_HZ, MAX_HZ);
+            }
+            responseModel.prepare(frequencies.data(), curveSize, sr);
+            responseModelSampleRate = sr;
+        }
+        responseCurveMagnitude.assign(static_cast<size_t>(curveSize), 0.0f);
         auto& apvts = audioProcessor.apvts;
         for (size_t i = 0; i < NUM_BANDS; ++i)
         {
@@ -538,21 +527,19 @@ private:
             {
                 const auto bandF = juce::jmin(apvts.getRawParameterValue(ID_PREFIX_FREQ + index)->load(), static_cast<float>(sr * 0.49));
                 const auto bandQ = apvts.getRawParameterValue(ID_PREFIX_Q + index)->load();
-                const auto bandG = juce::Decibels::decibelsToGain(apvts.getRawParameterValue(ID_PREFIX_GAIN + index)->load());
+                const auto bandG = apvts.getRawParameterValue(ID_PREFIX_GAIN + index)->load();
                 const auto bandT = static_cast<int>(apvts.getRawParameterValue(ID_PREFIX_TYPE + index)->load());
-                coefsBuffer.push_back(filterFactories[bandT](sr, bandF, bandQ, bandG));
+                const auto bandS = static_cast<int>(apvts.getRawParameterValue(ID_PREFIX_SLOPE + index)->load());
+                const auto cascade = coefficientCache.getCascade(BandTopology::Biquad, bandT, bandS, sr, bandF, bandQ, bandG);
+                for (int section = 0; section < cascade.sections; ++section)
+                {
+                    responseModel.addDecibels(cascade.stages[static_cast<size_t>(section)], responseCurveMagnitude.data());
+                }
             }
         }
-        for (int i = 0; i < curveSize; ++i)
+        for (auto& magnitude : responseCurveMagnitude)
         {
-            float normalizedX = (float)i / (float)(curveSize - 1);
-            float freqHz = juce::mapToLog10(normalizedX, minHz, maxHz);
-            float totalGainLinear = 1.0f;
-            for (const auto& coefs : coefsBuffer)
-            {
-                totalGainLinear *= coefs->getMagnitudeForFrequency(freqHz, sr);
-            }
-            responseCurveMagnitude[i] = juce::Decibels::gainToDecibels(totalGainLinear);
+            magnitude = juce::jmax(MIN_RESPONSE_DB, magnitude);
         }
         auto bounds = getCurveArea().toFloat();
         const float minDb = -24.0f;
@@ -574,57 +561,29 @@ private:
     static constexpr float MIN_HZ = 20.0f;
     static constexpr float MAX_HZ = 20000.0f;
     static constexpr float MIN_DBFS = -90.0f;
+    static constexpr float MIN_RESPONSE_DB = -100.0f;
     static constexpr float MAX_DBFS = 30.0f;
-    static constexpr int HALF_FONT_HEIGHT = 5;
-    static constexpr int FONT_HEIGHT = HALF_FONT_HEIGHT * 2;
+    static constexpr int HALF_FONT_HEIGHT = SharedEditorResources::HALF_FONT_HEIGHT;
+    static constexpr int FONT_HEIGHT = SharedEditorResources::FONT_HEIGHT;
     static constexpr int margin = 10;
-    static constexpr int THREAD_SLEEP_TIME = 20;
-    const std::vector<float> gridMarkers = {20.0f, 50.0f, 100.0f, 200.0f, 500.0f, 1000.0f, 2000.0f, 5000.0f, 10000.0f, 20000.0f};
-    const std::vector<juce::String> dbTags = {"+24", "+18", "+12", "+6", "0", "-6", "-12", "-18", "-24"};
-    const std::vector<juce::String> meterTags = {"+6", "+3", "0", "-3", "-6", "-9", "-12", "-15", "-18"};
+    static constexpr int RESIZE_SETTLE_TIME = 100;
+    juce::SharedResourcePointer<SharedEditorResources> sharedResources;
     QuasarEQAudioProcessor& audioProcessor;
-    PathProducer pathProducer;
+    AnalyzerJob& analyzerJob;
+    CoefficientCache& coefficientCache;
+    bool analyzerStarted = false;
     SpectrumRenderData channelPathToDraw;
     std::vector<juce::Point<float>> spectrumPoints;
     std::vector<juce::Point<float>> peakHoldPoints;
     std::vector<float> freqLUT;
     juce::CriticalSection pathLock;
-    juce::CriticalSection freqLUTLock;
-    juce::Image gridCache;
+    juce::Image gridImage;
+    float displayScale = 1.0f;
     juce::Path responseCurvePath;
-    class AnalyzerThread: public juce::Thread
-    {
-    public:
-        AnalyzerThread(PathProducer& producer, VisualizerComponent& comp): juce::Thread("FFT Analyzer Thread"), producer(producer), responseCurveComponent(comp)
-        {
-            startThread();
-        };
-        ~AnalyzerThread() override
-        {
-            stopThread(1000);
-        };
-        void run() override
-        {
-            while (!threadShouldExit())
-            {
-                producer.process(responseCurveComponent.audioProcessor.getSampleRate());
-                if (!responseCurveComponent.isUpdatePending() && producer.getNumPathsAvailable() > 0)
-                {
-                    responseCurveComponent.triggerAsyncUpdate();
-                }
-                juce::Thread::sleep(THREAD_SLEEP_TIME);
-            }
-        };
-    private:
-        PathProducer& producer;
-        VisualizerComponent& responseCurveComponent;
-    };
-    std::string getGridMarkerLabel(float value)
-    {
-        return  value < 1000.0f ? std::to_string(static_cast<int>(value)) : std::to_string(static_cast<int>(value / 1000.0f)) + "k";
-    }
-    AnalyzerThread analyzerThread;
+    SpectrogramComponent* spectrogram = nullptr;
     std::vector<float> responseCurveMagnitude;
+    ResponseModel responseModel;
+    double responseModelSampleRate = 0.0;
 };
 
 class CustomLNF: public juce::LookAndFeel_V4
@@ -712,7 +671,7 @@ class QuasarEQAudioProcessorEditor: public juce::AudioProcessorEditor
 public:
     QuasarEQAudioProcessorEditor(QuasarEQAudioProcessor& p): AudioProcessorEditor(&p), audioProcessor(p), visualizerComponent(p)
     {
-        setLookAndFeel(&customLNF);
+        setLookAndFeel(&customLNF.getObject());
         for (int i = 0; i < NUM_BANDS; ++i)
         {
             bandControls.push_back(std::make_unique<FilterBandControl>(audioProcessor.apvts, i));
@@ -724,13 +683,74 @@ public:
         gainSlider.setSliderStyle(juce::Slider::SliderStyle::LinearVertical);
         gainSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 48, 16);
         bypassButton.setClickingTogglesState(true);
+        idleSleepButton.setClickingTogglesState(true);
+        snapshotFadeButton.setClickingTogglesState(true);
+        for (int i = 0; i < NUM_SNAPSHOT_SLOTS; ++i)
+        {
+            auto& button = snapshotButtons[static_cast<size_t>(i)];
+            button.setClickingTogglesState(true);
+            button.setRadioGroupId(SNAPSHOT_RADIO_GROUP);
+            button.setToggleState(audioProcessor.getActiveSnapshotSlot() == i, juce::dontSendNotification);
+            button.onClick = [this, i]
+            {
+                if (snapshotButtons[static_cast<size_t>(i)].getToggleState())
+                {
+                    audioProcessor.selectSnapshotSlot(i);
+                }
+            };
+            addAndMakeVisible(button);
+        }
+        for (int i = 0; i < NUM_SPECTRUM_CAPTURES; ++i)
+        {
+            auto& button = captureButtons[static_cast<size_t>(i)];
+            button.setClickingTogglesState(true);
+            button.setToggleState(audioProcessor.getCapturingSlot() == i, juce::dontSendNotification);
+            button.onClick = [this, i]
+            {
+                if (captureButtons[static_cast<size_t>(i)].getToggleState())
+                {
+                    captureButtons[static_cast<size_t>(1 - i)].setToggleState(false, juce::dontSendNotification);
+                    audioProcessor.startSpectrumCapture(i);
+                }
+                else
+                {
+                    audioProcessor.stopSpectrumCapture();
+                }
+            };
+            addAndMakeVisible(button);
+        }
+        matchButton.onClick = [this]
+        {
+            for (auto& button : captureButtons)
+            {
+                button.setToggleState(false, juce::dontSendNotification);
+            }
+            audioProcessor.stopSpectrumCapture();
+            audioProcessor.matchSpectrum();
+        };
+        addAndMakeVisible(matchButton);
+        analyzerTapBox.setJustificationType(juce::Justification::centred);
+        analyzerTapBox.addItemList(analyzerTapTags, 1);
+        visualizerComponent.attachSpectrogram(&spectrogramComponent);
         addAndMakeVisible(visualizerComponent);
+        addAndMakeVisible(spectrogramComponent);
         addAndMakeVisible(pluginInfoLabel);
         addAndMakeVisible(gainSlider);
         addAndMakeVisible(bypassButton);
+        addAndMakeVisible(analyzerTapBox);
+        addAndMakeVisible(idleSleepButton);
+        addAndMakeVisible(snapshotFadeButton);
+#if QUASAR_PROFILING
+        addAndMakeVisible(profilerOverlay);
+#endif
         outGainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, ID_GAIN, gainSlider);
         bypassAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, ID_GLOBAL_BYPASS, bypassButton);
-        setSize(657, windowHeight);
+        analyzerTapAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, ID_ANALYZER_TAP, analyzerTapBox);
+        idleSleepAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, ID_IDLE_SLEEP, idleSleepButton);
+        snapshotFadeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, ID_SNAPSHOT_FADE, snapshotFadeButton);
+        setResizable(true, true);
+        setResizeLimits(windowWidth * 3 / 4, windowHeight * 3 / 4, windowWidth * 5 / 2, windowHeight * 5 / 2);
+        setSize(windowWidth, windowHeight);
     };
     QuasarEQAudioProcessorEditor::~QuasarEQAudioProcessorEditor()
     {
@@ -741,20 +761,40 @@ public:
         g.fillAll(BACKGROUND_COLOR);
     }
     static constexpr int margin = 4;
+    static constexpr int windowWidth = 657;
     static constexpr int topSectionH = 38;
     static constexpr int midSectionH = 300;
-    static constexpr int botSectionH = 300;
-    static constexpr int windowHeight = margin * 2 + topSectionH + midSectionH + botSectionH;
+    static constexpr int specSectionH = 110;
+    static constexpr int botSectionH = 450;
+    static constexpr int windowHeight = margin * 2 + topSectionH + midSectionH + specSectionH + botSectionH;
     void resized() override
     {
         juce::Rectangle<int> mainArea = getLocalBounds().reduced(margin);
         juce::Rectangle<int> top = mainArea.removeFromTop(topSectionH).reduced(margin);
-        juce::Rectangle<int> mid = mainArea.removeFromTop(midSectionH).reduced(margin);
-        juce::Rectangle<int> bot = mainArea.removeFromTop(botSectionH).reduced(margin);
+        const float scalableHeight = static_cast<float>(mainArea.getHeight()) / (midSectionH + specSectionH + botSectionH);
+        juce::Rectangle<int> mid = mainArea.removeFromTop(juce::roundToInt(midSectionH * scalableHeight)).reduced(margin);
+        juce::Rectangle<int> spec = mainArea.removeFromTop(juce::roundToInt(specSectionH * scalableHeight)).reduced(margin);
+        juce::Rectangle<int> bot = mainArea.reduced(margin);
         const int sideSize = 55;
         bypassButton.setBounds(top.removeFromLeft(sideSize).reduced(margin));
+        analyzerTapBox.setBounds(top.removeFromRight(sideSize * 2).reduced(margin));
+        idleSleepButton.setBounds(top.removeFromRight(sideSize).reduced(margin));
+        snapshotFadeButton.setBounds(top.removeFromRight(sideSize).reduced(margin));
+        for (int i = NUM_SNAPSHOT_SLOTS; --i >= 0;)
+        {
+            snapshotButtons[static_cast<size_t>(i)].setBounds(top.removeFromRight(sideSize / 2).reduced(margin));
+        }
+        matchButton.setBounds(top.removeFromRight(sideSize * 3 / 4).reduced(margin));
+        for (int i = NUM_SPECTRUM_CAPTURES; --i >= 0;)
+        {
+            captureButtons[static_cast<size_t>(i)].setBounds(top.removeFromRight(sideSize * 3 / 4).reduced(margin));
+        }
         pluginInfoLabel.setBounds(top.reduced(margin));
         visualizerComponent.setBounds(mid);
+#if QUASAR_PROFILING
+        profilerOverlay.setBounds(mid.getRight() - ProfilerOverlay::WIDTH - margin, mid.getY() + margin, ProfilerOverlay::WIDTH, ProfilerOverlay::HEIGHT);
+#endif
+        spectrogramComponent.setBounds(spec);
         gainSlider.setBounds(bot.removeFromRight(20 * 3).reduced(margin));
         bot.reduce(margin, margin);
         const int bandWidth = bot.getWidth() / NUM_BANDS;
@@ -767,12 +807,13 @@ public:
         }
     };
 private:
+    static constexpr int SNAPSHOT_RADIO_GROUP = 1;
     const juce::Colour BACKGROUND_COLOR = juce::Colour(juce::uint8(40), juce::uint8(42), juce::uint8(50));
     class CustomSlider: public juce::Slider { public:void mouseDoubleClick (const juce::MouseEvent& event) override {}; };
     class CustomButton: public juce::Button
     {
     public:
-        CustomButton(): juce::Button("PowerButton") {}
+        CustomButton(const juce::String& labelText = "Bypass"): juce::Button("PowerButton"), label(labelText) {}
         void paintButton(juce::Graphics& g, bool isMouseOverButton, bool isButtonDown) override
         {
             const auto isBypass = getToggleState();
@@ -783,7 +824,7 @@ private:
             g.setColour(color);
             g.drawRect(bounds, 2.0f);
             g.setFont(12.0f);
-            g.drawText("Bypass", getLocalBounds(), juce::Justification::centred);
+            g.drawText(label, getLocalBounds(), juce::Justification::centred);
         }
         void mouseEnter(const juce::MouseEvent& event) override
         {
@@ -793,6 +834,8 @@ private:
         {
             setMouseCursor(juce::MouseCursor::NormalCursor);
         }
+    private:
+        juce::String label;
     };
     class FilterBandControl: public juce::Component
     {
@@ -801,8 +844,15 @@ private:
         {
             typeComboBox.setJustificationType(juce::Justification::centred);
             typeComboBox.addItemList (filterTags, 1);
+            routeComboBox.setJustificationType(juce::Justification::centred);
+            routeComboBox.addItemList (routeTags, 1);
+            topologyComboBox.setJustificationType(juce::Justification::centred);
+            topologyComboBox.addItemList (topologyTags, 1);
+            slopeComboBox.setJustificationType(juce::Justification::centred);
+            slopeComboBox.addItemList (slopeTags, 1);
             bypassButton.setClickingTogglesState(true);
-            for (auto* s : {&freqSlider, &gainSlider, &qSlider})
+            dynamicButton.setClickingTogglesState(true);
+            for (auto* s : {&freqSlider, &gainSlider, &qSlider, &thresholdSlider, &ratioSlider, &attackSlider, &releaseSlider})
             {
                 s->setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
                 s->setTextBoxStyle (juce::Slider::TextBoxBelow, false, 48, 16);
@@ -817,6 +867,14 @@ private:
             qAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, ID_PREFIX_Q + index, qSlider);
             typeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, ID_PREFIX_TYPE + index, typeComboBox);
             bypassAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(apvts, ID_PREFIX_BYPASS + index, bypassButton);
+            routeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, ID_PREFIX_ROUTE + index, routeComboBox);
+            topologyAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, ID_PREFIX_TOPOLOGY + index, topologyComboBox);
+            slopeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, ID_PREFIX_SLOPE + index, slopeComboBox);
+            dynamicAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(apvts, ID_PREFIX_DYNAMIC + index, dynamicButton);
+            thresholdAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, ID_PREFIX_THRESHOLD + index, thresholdSlider);
+            ratioAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, ID_PREFIX_RATIO + index, ratioSlider);
+            attackAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, ID_PREFIX_ATTACK + index, attackSlider);
+            releaseAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, ID_PREFIX_RELEASE + index, releaseSlider);
         };
         ~FilterBandControl() override {};
         void resized() override
@@ -826,32 +884,75 @@ private:
             bypassButton.setBounds(topHeader.reduced(margin));
             auto secHeader = bounds.removeFromTop(30);
             typeComboBox.setBounds(secHeader.reduced(margin));
+            auto routeHeader = bounds.removeFromTop(30);
+            routeComboBox.setBounds(routeHeader.reduced(margin));
+            auto topologyHeader = bounds.removeFromTop(30);
+            topologyComboBox.setBounds(topologyHeader.reduced(margin));
+            auto slopeHeader = bounds.removeFromTop(30);
+            slopeComboBox.setBounds(slopeHeader.reduced(margin));
+            auto dynamicHeader = bounds.removeFromTop(30);
+            dynamicButton.setBounds(dynamicHeader.reduced(margin));
             bounds.reduce(margin, margin);
-            int controlHeight = bounds.getHeight() / 3;
+            int controlHeight = bounds.getHeight() / 5;
             freqSlider.setBounds(bounds.removeFromTop(controlHeight).reduced(margin));
             gainSlider.setBounds(bounds.removeFromTop(controlHeight).reduced(margin));
-            qSlider.setBounds(bounds.reduced(margin));
+            qSlider.setBounds(bounds.removeFromTop(controlHeight).reduced(margin));
+            auto levelRow = bounds.removeFromTop(controlHeight);
+            thresholdSlider.setBounds(levelRow.removeFromLeft(levelRow.getWidth() / 2));
+            ratioSlider.setBounds(levelRow);
+            auto timeRow = bounds;
+            attackSlider.setBounds(timeRow.removeFromLeft(timeRow.getWidth() / 2));
+            releaseSlider.setBounds(timeRow);
         };
     private:
-        std::vector<juce::Component*> allComponents {&typeComboBox, &bypassButton, &freqSlider, &gainSlider, &qSlider};
+        std::vector<juce::Component*> allComponents {&typeComboBox, &routeComboBox, &topologyComboBox, &slopeComboBox, &bypassButton, &freqSlider, &gainSlider, &qSlider, &dynamicButton, &thresholdSlider, &ratioSlider, &attackSlider, &releaseSlider};
         CustomButton bypassButton;
+        CustomButton dynamicButton {"Dynamic"};
         juce::Slider freqSlider;
         juce::Slider gainSlider;
         juce::Slider qSlider;
+        juce::Slider thresholdSlider;
+        juce::Slider ratioSlider;
+        juce::Slider attackSlider;
+        juce::Slider releaseSlider;
         juce::ComboBox typeComboBox;
+        juce::ComboBox routeComboBox;
+        juce::ComboBox topologyComboBox;
+        juce::ComboBox slopeComboBox;
         std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> bypassAttachment;
         std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> freqAttachment;
         std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gainAttachment;
         std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> qAttachment;
         std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> typeAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> routeAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> topologyAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> slopeAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> dynamicAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> thresholdAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> ratioAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> attackAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> releaseAttachment;
     };
-    CustomLNF customLNF;
+    juce::SharedResourcePointer<CustomLNF> customLNF;
     CustomButton bypassButton;
+    CustomButton idleSleepButton {"Sleep"};
+    CustomButton snapshotFadeButton {"Fade"};
+    std::array<CustomButton, NUM_SNAPSHOT_SLOTS> snapshotButtons {CustomButton {"A"}, CustomButton {"B"}};
+    std::array<CustomButton, NUM_SPECTRUM_CAPTURES> captureButtons {CustomButton {"Ref"}, CustomButton {"Target"}};
+    CustomButton matchButton {"Match"};
     CustomSlider gainSlider;
     QuasarEQAudioProcessor& audioProcessor;
+    SpectrogramComponent spectrogramComponent;
     VisualizerComponent visualizerComponent;
+#if QUASAR_PROFILING
+    ProfilerOverlay profilerOverlay {audioProcessor.getProfiler()};
+#endif
     juce::Label pluginInfoLabel;
+    juce::ComboBox analyzerTapBox;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> bypassAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> outGainAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> analyzerTapAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> idleSleepAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> snapshotFadeAttachment;
     std::vector<std::unique_ptr<FilterBandControl>> bandControls;
 };
@@ -2,4 +2,18 @@
 #include "PluginEditor.h"
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter() { return new QuasarEQAudioProcessor(); }
-juce::AudioProcessorEditor* QuasarEQAudioProcessor::createEditor() { return new QuasarEQAudioProcessorEditor(*this); }
+QuasarEQAudioProcessor::~QuasarEQAudioProcessor()
+{
+    for (auto* parameter : getParameters())
+    {
+        parameter->removeListener(this);
+    }
+}
+juce::AudioProcessorEditor* QuasarEQAudioProcessor::createEditor()
+{
+    if (editorResources == nullptr)
+    {
+        editorResources = std::make_unique<juce::SharedResourcePointer<SharedEditorResources>>();
+    }
+    return new QuasarEQAudioProcessorEditor(*this);
+}
@@ -1,39 +1,67 @@
 #pragma once
 #include <JuceHeader.h>
 #include "QFifo.h"
+#include "QAnalyzer.h"
+#include "QFilterBank.h"
+#include "QFilterDesign.h"
+#include "QCoefficientCache.h"
+#include "QDynamics.h"
+#include "QSpectrumMatch.h"
+#include "QSharedExport.h"
+#include "QStateFormat.h"
+#include "QSnapshot.h"
+#include "QProfiler.h"
+#include "QRealtimeCheck.h"
 static inline const juce::String ID_GLOBAL_BYPASS {"bypass"};
 static inline const juce::String ID_GAIN {"outGain"};
+static inline const juce::String ID_ANALYZER_TAP {"analyzerTap"};
+static inline const juce::String ID_IDLE_SLEEP {"idleSleep"};
+static inline const juce::String ID_SNAPSHOT_FADE {"snapshotFade"};
 static inline const juce::String ID_PREFIX_FREQ {"Freq"};
 static inline const juce::String ID_PREFIX_GAIN {"Gain"};
 static inline const juce::String ID_PREFIX_Q {"Q"};
 static inline const juce::String ID_PREFIX_TYPE {"Type"};
 static inline const juce::String ID_PREFIX_BYPASS {"Bypass"};
+static inline const juce::String ID_PREFIX_ROUTE {"Route"};
+static inline const juce::String ID_PREFIX_TOPOLOGY {"Topology"};
+static inline const juce::String ID_PREFIX_SLOPE {"Slope"};
+static inline const juce::String ID_PREFIX_DYNAMIC {"Dynamic"};
+static inline const juce::String ID_PREFIX_THRESHOLD {"Threshold"};
+static inline const juce::String ID_PREFIX_RATIO {"Ratio"};
+static inline const juce::String ID_PREFIX_ATTACK {"Attack"};
+static inline const juce::String ID_PREFIX_RELEASE {"Release"};
 static inline const juce::String ID_PARAMETERS {"Parameters"};
 static inline const juce::String NAME_GLOBAL_BYPASS {"Bypass"};
 static inline const juce::String NAME_GAIN {"Gain"};
+static inline const juce::String NAME_ANALYZER_TAP {"Analyzer Tap"};
+static inline const juce::String NAME_IDLE_SLEEP {"Idle Sleep"};
+static inline const juce::String NAME_SNAPSHOT_FADE {"Snapshot Fade"};
 static inline const juce::String NAME_PREFIX_FREQ {"Freq"};
 static inline const juce::String NAME_PREFIX_GAIN {"Gain"};
 static inline const juce::String NAME_PREFIX_Q {"Q"};
 static inline const juce::String NAME_PREFIX_TYPE {"Type"};
 static inline const juce::String NAME_PREFIX_BYPASS {"Bypass"};
+static inline const juce::String NAME_PREFIX_ROUTE {"Route"};
+static inline const juce::String NAME_PREFIX_TOPOLOGY {"Topology"};
+static inline const juce::String NAME_PREFIX_SLOPE {"Slope"};
+static inline const juce::String NAME_PREFIX_DYNAMIC {"Dynamic"};
+static inline const juce::String NAME_PREFIX_THRESHOLD {"Threshold"};
+static inline const juce::String NAME_PREFIX_RATIO {"Ratio"};
+static inline const juce::String NAME_PREFIX_ATTACK {"Attack"};
+static inline const juce::String NAME_PREFIX_RELEASE {"Release"};
 static inline const juce::String NAME_PREFIX_BAND {"Band"};
 static inline const juce::String UNIT_HZ {"Hz"};
 static inline const juce::String UNIT_DB {"dB"};
+static inline const juce::String UNIT_MS {"ms"};
 static inline const juce::StringArray filterTags {"HighPass", "HighShelf", "LowPass", "LowShelf", "Peak"};
-static inline const juce::StringArray bandParamPrefixes = {ID_PREFIX_FREQ, ID_PREFIX_GAIN, ID_PREFIX_Q, ID_PREFIX_TYPE, ID_PREFIX_BYPASS};
+static inline const juce::StringArray analyzerTapTags {"Front L/R", "Downmix"};
+static inline const juce::StringArray routeTags {"Stereo", "Left", "Right", "Mid", "Side"};
+static inline const juce::StringArray topologyTags {"Biquad", "SVF"};
+static inline const juce::StringArray slopeTags {"12 dB/oct", "24 dB/oct", "24 dB/oct LR", "36 dB/oct", "48 dB/oct", "48 dB/oct LR", "72 dB/oct", "96 dB/oct"};
+static inline const juce::StringArray bandParamPrefixes = {ID_PREFIX_FREQ, ID_PREFIX_GAIN, ID_PREFIX_Q, ID_PREFIX_TYPE, ID_PREFIX_BYPASS, ID_PREFIX_ROUTE, ID_PREFIX_TOPOLOGY, ID_PREFIX_SLOPE, ID_PREFIX_DYNAMIC, ID_PREFIX_THRESHOLD, ID_PREFIX_RATIO, ID_PREFIX_ATTACK, ID_PREFIX_RELEASE};
 static constexpr int NUM_BANDS = 8;
-using T = float;
-template <juce::dsp::IIR::Coefficients<T>::Ptr (*F)(double, T, T, T)>
-static constexpr juce::dsp::IIR::Coefficients<T>::Ptr wrap(double sr, T f, T q, T g) { return F(sr, f, q, g); }
-template <juce::dsp::IIR::Coefficients<T>::Ptr (*F)(double, T, T)>
-static constexpr juce::dsp::IIR::Coefficients<T>::Ptr wrap(double sr, T f, T q, T) { return F(sr, f, q); }
-static constexpr juce::dsp::IIR::Coefficients<T>::Ptr (*filterFactories[])(double, T, T, T) = {
-    wrap<juce::dsp::IIR::Coefficients<T>::makeHighPass>,
-    wrap<juce::dsp::IIR::Coefficients<T>::makeHighShelf>,
-    wrap<juce::dsp::IIR::Coefficients<T>::makeLowPass>,
-    wrap<juce::dsp::IIR::Coefficients<T>::makeLowShelf>,
-    wrap<juce::dsp::IIR::Coefficients<T>::makePeakFilter>
-};
+static constexpr int MAX_CHANNELS = 16;
+struct SharedEditorResources;
 template <typename T>
 constexpr T constexpr_sqrt(T x)
 {
@@ -52,13 +80,26 @@ constexpr T constexpr_sqrt(T x)
     }
     return curr;
 }
-template <size_t... I>
-auto make_chain_type(std::index_sequence<I...>) -> juce::dsp::ProcessorChain < std::decay_t<decltype((void)I, juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>>{}) > ... > ;
-template <size_t N>
-using FilterChain = decltype(make_chain_type(std::make_index_sequence<N>{}));
 static constexpr bool GLOBAL_BYPASS_DEFAULT = false;
 static constexpr bool BYPASS_DEFAULT = true;
 static constexpr int TYPE_DEFAULT = 4;
+static constexpr int ROUTE_DEFAULT = 0;
+static constexpr int TOPOLOGY_DEFAULT = 0;
+static constexpr int SLOPE_DEFAULT = 0;
+static constexpr bool DYNAMIC_DEFAULT = false;
+static constexpr double SVF_GLIDE_SECONDS = 0.005;
+static constexpr int ANALYZER_TAP_DEFAULT = 0;
+static constexpr bool IDLE_SLEEP_DEFAULT = true;
+static constexpr bool SNAPSHOT_FADE_DEFAULT = true;
+static constexpr double SNAPSHOT_FADE_SECONDS = 0.02;
+static constexpr int NUM_SNAPSHOT_SLOTS = 2;
+static constexpr int CAPTURE_REFERENCE = 0;
+static constexpr int CAPTURE_TARGET = 1;
+static constexpr int NUM_SPECTRUM_CAPTURES = 2;
+static inline const juce::String SHARED_EXPORT_ENVIRONMENT {"QUASAR_SHARED_EXPORT"};
+static constexpr float SILENCE_THRESHOLD = 1.0e-8f;
+static constexpr double TAIL_DECAY_THRESHOLD = 1.0e-6;
+static constexpr double MAX_TAIL_SECONDS = 10.0;
 static constexpr float FREQ_START = 20.0f;
 static constexpr float FREQ_END = 20000.0f;
 static constexpr float FREQ_INTERVAL = 0.1f;
@@ -71,7 +112,48 @@ static constexpr float QUAL_START = 0.05f;
 static constexpr float QUAL_END = 12.0f;
 static constexpr float QUAL_INTERVAL = 0.001f;
 static constexpr float QUAL_CENTRE = 1.0f / juce::MathConstants<float>::sqrt2;
-class QuasarEQAudioProcessor: public juce::AudioProcessor, public juce::AudioProcessorValueTreeState::Listener
+static constexpr float THRESHOLD_START = -60.0f;
+static constexpr float THRESHOLD_END = 0.0f;
+static constexpr float THRESHOLD_INTERVAL = 0.1f;
+static constexpr float THRESHOLD_DEFAULT = -20.0f;
+static constexpr float RATIO_START = 1.0f;
+static constexpr float RATIO_END = 20.0f;
+static constexpr float RATIO_INTERVAL = 0.01f;
+static constexpr float RATIO_CENTRE = 2.0f;
+static constexpr float ATTACK_START = 0.1f;
+static constexpr float ATTACK_END = 200.0f;
+static constexpr float ATTACK_INTERVAL = 0.1f;
+static constexpr float ATTACK_CENTRE = 10.0f;
+static constexpr float RELEASE_START = 5.0f;
+static constexpr float RELEASE_END = 2000.0f;
+static constexpr float RELEASE_INTERVAL = 1.0f;
+static constexpr float RELEASE_CENTRE = 150.0f;
+static_assert(CoefficientCache::FREQ_STEP == FREQ_INTERVAL && CoefficientCache::QUAL_STEP == QUAL_INTERVAL && CoefficientCache::GAIN_STEP == GAIN_INTERVAL);
+struct BandParameters
+{
+    juce::AudioParameterFloat* freq = nullptr;
+    juce::AudioParameterFloat* gain = nullptr;
+    juce::AudioParameterFloat* q = nullptr;
+    juce::AudioParameterChoice* type = nullptr;
+    juce::AudioParameterBool* bypass = nullptr;
+    juce::AudioParameterChoice* route = nullptr;
+    juce::AudioParameterChoice* topology = nullptr;
+    juce::AudioParameterChoice* slope = nullptr;
+    juce::AudioParameterBool* dynamic = nullptr;
+    juce::AudioParameterFloat* threshold = nullptr;
+    juce::AudioParameterFloat* ratio = nullptr;
+    juce::AudioParameterFloat* attack = nullptr;
+    juce::AudioParameterFloat* release = nullptr;
+};
+struct BandEdit
+{
+    float freq = 0.0f;
+    float gain = 0.0f;
+    float q = 0.0f;
+    bool position = false;
+    bool quality = false;
+};
+class QuasarEQAudioProcessor: public juce::AudioProcessor, private juce::AudioProcessorParameter::Listener
 {
 public:
     QuasarEQAudioProcessor()
@@ -87,17 +169,42 @@ public:
 #endif
         , apvts(*this, nullptr, ID_PARAMETERS, createParameterLayout())
     {
-        apvts.addParameterListener(ID_GAIN, this);
-        apvts.addParameterListener(ID_GLOBAL_BYPASS, this);
+        gainParameter = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ID_GAIN));
+        globalBypassParameter = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(ID_GLOBAL_BYPASS));
+        analyzerTapParameter = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(ID_ANALYZER_TAP));
+        idleSleepParameter = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(ID_IDLE_SLEEP));
+        snapshotFadeParameter = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(ID_SNAPSHOT_FADE));
         for (int i = 0; i < NUM_BANDS; ++i)
         {
-            const juce::String index = juce::String (i + 1);
-            for (const auto& prefix : bandParamPrefixes)
-            {
-                apvts.addParameterListener (prefix + index, this);
-            }
+            const juce::String index = juce::String(i + 1);
+            auto& band = bandParameters[i];
+            band.freq = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ID_PREFIX_FREQ + index));
+            band.gain = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ID_PREFIX_GAIN + index));
+            band.q = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ID_PREFIX_Q + index));
+            band.type = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(ID_PREFIX_TYPE + index));
+            band.bypass = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(ID_PREFIX_BYPASS + index));
+            band.route = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(ID_PREFIX_ROUTE + index));
+            band.topology = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(ID_PREFIX_TOPOLOGY + index));
+            band.slope = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(ID_PREFIX_SLOPE + index));
+            band.dynamic = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(ID_PREFIX_DYNAMIC + index));
+            band.threshold = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ID_PREFIX_THRESHOLD + index));
+            band.ratio = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ID_PREFIX_RATIO + index));
+            band.attack = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ID_PREFIX_ATTACK + index));
+            band.release = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ID_PREFIX_RELEASE + index));
+        }
+        const auto& parameters = getParameters();
+        parameterRoutes.assign(static_cast<size_t>(parameters.size()), 0);
+        for (auto* parameter : parameters)
+        {
+            parameterRoutes[static_cast<size_t>(parameter->getParameterIndex())] = findParameterRoute(parameter);
+            parameter->addListener(this);
+        }
+        if (juce::SystemStats::getEnvironmentVariable(SHARED_EXPORT_ENVIRONMENT, {}).isNotEmpty())
+        {
+            setSharedExportEnabled(true);
         }
     }
+    ~QuasarEQAudioProcessor() override;
 #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported(const BusesLayout& layouts) const
     {
@@ -106,7 +213,7 @@ public:
             return true;
         }
         const auto mainOutput = layouts.getMainOutputChannelSet();
-        if (mainOutput != juce::AudioChannelSet::mono() && mainOutput != juce::AudioChannelSet::stereo())
+        if (mainOutput.isDisabled() || mainOutput.size() > MAX_CHANNELS)
         {
             return false;
         }
@@ -123,33 +230,98 @@ public:
         spec.sampleRate = sampleRate;
         spec.maximumBlockSize = (juce::uint32)samplesPerBlock;
         spec.numChannels = (juce::uint32)getTotalNumOutputChannels();
-        leftChannelFifo.prepare(samplesPerBlock);
-        rightChannelFifo.prepare(samplesPerBlock);
-        filterChain.prepare(spec);
-        filterChain.reset();
+        leftChannelFifo.reset();
+        rightChannelFifo.reset();
+        publishAnalyzerConfig(sampleRate, samplesPerBlock);
+        prepareAnalyzerTaps(getChannelLayoutOfBus(false, 0));
+        simdIsa = SimdDispatch::select();
+        filterBank.setSimdIsa(simdIsa);
+        analyzerJob.getPathProducer().setSimdIsa(simdIsa);
+        filterBank.prepare(getTotalNumOutputChannels(), samplesPerBlock);
+        filterBank.setDoublePrecision(isNonRealtime());
+        dynamicEq.prepare(sampleRate);
+        silentSamples = 0;
+        sleeping = false;
         outGain.prepare(spec);
-        outGain.reset();
+        svfGlideSamples = 0;
+        updateFlags.fetch_and(~ALL_UPDATE_MASK);
         updateFilters(ALL_UPDATE_MASK);
+        outGain.reset();
+        svfGlideSamples = juce::roundToInt(SVF_GLIDE_SECONDS * sampleRate);
     }
     void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) override
     {
         juce::ScopedNoDenormals noDenormals;
+        QUASAR_RT_AUDIO_SCOPE;
+        QUASAR_PROFILE_STAGE(profiler, Block);
         auto totalNumInputChannels = getTotalNumInputChannels();
         auto totalNumOutputChannels = getTotalNumOutputChannels();
         for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         {
             buffer.clear(i, 0, buffer.getNumSamples());
         }
-        if (auto flags = updateFlags.exchange(0))
+        if (precisionChanged.exchange(false, std::memory_order_acquire))
+        {
+            filterBank.setDoublePrecision(isNonRealtime());
+        }
+        if (auto* snapshot = snapshots.acquire())
+        {
+            applySnapshot(*snapshot);
+            snapshots.retire(snapshot);
+        }
+        if (parameterBatchDepth.load(std::memory_order_acquire) == 0)
+        {
+            if (auto flags = updateFlags.exchange(0))
+            {
+                QUASAR_PROFILE_STAGE(profiler, UpdateFilters);
+                updateFilters(flags);
+            }
+        }
+        if (idleSleepParameter->get() && !isNonRealtime() && isSilent(buffer, totalNumInputChannels))
+        {
+            if (silentSamples >= tailSamples)
+            {
+                if (!sleeping)
+                {
+                    filterBank.reset();
+                    dynamicEq.reset();
+                    sleeping = true;
+                }
+                buffer.clear();
+            }
+            silentSamples += buffer.getNumSamples();
+        }
+        else
+        {
+            silentSamples = 0;
+            sleeping = false;
+        }
+        if (!sleeping)
+        {
+            {
+                QUASAR_PROFILE_STAGE(profiler, FilterBank);
+                if (dynamicEq.isActive())
+                {
+                    processDynamicBands(buffer, totalNumInputChannels);
+                }
+                else
+                {
+                    filterBank.process(buffer);
+                }
+            }
+            QUASAR_PROFILE_STAGE(profiler, OutGain);
+            juce::dsp::AudioBlock<float> block(buffer);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            outGain.process(context);
+        }
+        QUASAR_PROFILE_STAGE(profiler, AnalyzerFifo);
+        if (!analyzerEnabled.load(std::memory_order_relaxed))
         {
-            updateFilters(flags);
+            return;
         }
-        juce::dsp::AudioBlock<float> block(buffer);
-        juce::dsp::ProcessContextReplacing<float> context(block);
-        filterChain.process(context);
-        outGain.process(context);
-        leftChannelFifo.update(buffer);
-        rightChannelFifo.update(buffer);
+        const auto& tap = analyzerTapMasks[static_cast<size_t>(analyzerTapParameter->getIndex())];
+        leftChannelFifo.update(buffer, tap[0]);
+        rightChannelFifo.update(buffer, tap[1]);
     }
     int getNumPrograms() override { return 1; }
     int getCurrentProgram() override { return 0; }
@@ -158,74 +330,688 @@ public:
     bool isMidiEffect() const override { return JucePlugin_IsMidiEffect; };
     bool producesMidi() const override { return JucePlugin_ProducesMidiOutput; };
     void releaseResources() override {};
+    void setNonRealtime(bool shouldBeNonRealtime) noexcept override
+    {
+        juce::AudioProcessor::setNonRealtime(shouldBeNonRealtime);
+        precisionChanged.store(true, std::memory_order_release);
+    }
     void setCurrentProgram(int index) override {};
     void changeProgramName(int index, const juce::String& newName) override {};
-    double getTailLengthSeconds() const override { return 0.0; };
+    double getTailLengthSeconds() const override { return tailSeconds.load(std::memory_order_relaxed); };
     const juce::String getName() const override { return JucePlugin_Name; }
     const juce::String getProgramName(int index) override { return {}; }
     void getStateInformation(juce::MemoryBlock& destData) override
     {
-        juce::MemoryOutputStream stream(destData, false);
-        apvts.state.writeToStream(stream);
+        captureState().write(destData);
     };
     void setStateInformation(const void* data, int sizeInBytes) override
     {
+        if (BinaryState<NUM_BANDS>::isBinaryState(data, sizeInBytes))
+        {
+            auto state = captureDefaultState();
+            if (state.read(data, sizeInBytes))
+            {
+                applyState(state, ALL_UPDATE_MASK);
+            }
+            return;
+        }
         auto tree = juce::ValueTree::readFromData(data, size_t(sizeInBytes));
         if (tree.isValid())
         {
+            beginParameterBatch();
             apvts.replaceState(tree);
+            endParameterBatch(ALL_UPDATE_MASK);
         }
     };
+    void beginParameterBatch()
+    {
+        parameterBatchDepth.fetch_add(1, std::memory_order_acq_rel);
+    }
+    void endParameterBatch(uint32_t flags)
+    {
+        if (parameterBatchDepth.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            updateFlags.fetch_or(flags);
+            parameterVersion.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    void commitBandEdit(int band, const BandEdit& edit)
+    {
+        const auto& target = bandParameters[band];
+        beginParameterBatch();
+        if (edit.position)
+        {
+            setParameter(target.freq, edit.freq);
+            setParameter(target.gain, edit.gain);
+        }
+        if (edit.quality)
+        {
+            setParameter(target.q, edit.q);
+        }
+        endParameterBatch(0);
+    }
     juce::AudioProcessorEditor* createEditor() override;
-    void parameterChanged(const juce::String& parameterID, float newValue)
+    void selectSnapshotSlot(int slot)
     {
-        if (parameterID == ID_GAIN || parameterID == ID_GLOBAL_BYPASS)
+        if (slot < 0 || slot >= NUM_SNAPSHOT_SLOTS || slot == activeSnapshotSlot)
         {
-            updateFlags.fetch_or(1 << NUM_BANDS);
+            return;
         }
-        else
+        snapshotSlots[static_cast<size_t>(activeSnapshotSlot)] = captureState();
+        snapshotSlotStored[static_cast<size_t>(activeSnapshotSlot)] = true;
+        activeSnapshotSlot = slot;
+        if (!snapshotSlotStored[static_cast<size_t>(slot)])
         {
-            int bandNum = parameterID.getTrailingIntValue();
-            if (bandNum >= 1 && bandNum <= NUM_BANDS)
+            snapshotSlots[static_cast<size_t>(slot)] = snapshotSlots[static_cast<size_t>(1 - slot)];
+            snapshotSlotStored[static_cast<size_t>(slot)] = true;
+            return;
+        }
+        recallSnapshot(snapshotSlots[static_cast<size_t>(slot)]);
+    }
+    int getActiveSnapshotSlot() const
+    {
+        return activeSnapshotSlot;
+    }
+    void recallSnapshot(const BinaryState<NUM_BANDS>& recalled)
+    {
+        auto state = recalled;
+        state.analyzerTap = static_cast<juce::uint8>(analyzerTapParameter->getIndex());
+        state.idleSleep = idleSleepParameter->get() ? 1 : 0;
+        state.snapshotFade = snapshotFadeParameter->get() ? 1 : 0;
+        auto snapshot = std::make_unique<PresetSnapshot<NUM_BANDS>>();
+        snapshot->state = state;
+        snapshot->sampleRate = getSampleRate();
+        snapshot->gainDecibels = state.outGain;
+        snapshot->globalBypass = state.bypass != 0;
+        const double sr = snapshot->sampleRate > 0.0 ? snapshot->sampleRate : 44100.0;
+        for (int i = 0; i < NUM_BANDS; ++i)
+        {
+            const auto& band = state.bands[static_cast<size_t>(i)];
+            const int type = juce::jlimit(0, filterTags.size() - 1, static_cast<int>(band.type));
+            const auto bandF = juce::jmin(band.freq, static_cast<float>(sr * 0.49));
+            const auto topology = static_cast<BandTopology>(juce::jlimit(0, topologyTags.size() - 1, static_cast<int>(band.topology)));
+            const int slope = juce::jlimit(0, slopeTags.size() - 1, static_cast<int>(band.slope));
+            snapshot->coefficients[static_cast<size_t>(i)] = coefficientCache->getCascade(topology, type, slope, sr, bandF, band.q, band.gain, getCacheCounters());
+            snapshot->topologies[static_cast<size_t>(i)] = topology;
+            snapshot->bypassed[static_cast<size_t>(i)] = snapshot->globalBypass || band.bypass != 0;
+            snapshot->routings[static_cast<size_t>(i)] = static_cast<BandRouting>(juce::jlimit(0, routeTags.size() - 1, static_cast<int>(band.route)));
+            snapshot->dynamics[static_cast<size_t>(i)] = getDynamicSettings(band, snapshot->globalBypass);
+        }
+        beginParameterBatch();
+        updateFlags.fetch_and(~getStateRoutes(state));
+        snapshots.publish(std::move(snapshot));
+        recallThread.store(juce::Thread::getCurrentThreadId(), std::memory_order_release);
+        applyState(state, 0);
+        recallThread.store(nullptr, std::memory_order_release);
+        endParameterBatch(0);
+    }
+    void parameterValueChanged(int parameterIndex, float newValue) override
+    {
+        if (recallThread.load(std::memory_order_acquire) == juce::Thread::getCurrentThreadId())
+        {
+            return;
+        }
+        if (parameterBatchDepth.load(std::memory_order_acquire) == 0)
+        {
+            parameterVersion.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (parameterIndex >= 0 && parameterIndex < static_cast<int>(parameterRoutes.size()))
+        {
+            updateFlags.fetch_or(parameterRoutes[static_cast<size_t>(parameterIndex)]);
+        }
+    };
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override {};
+    uint32_t getParameterVersion() const
+    {
+        return parameterVersion.load(std::memory_order_relaxed);
+    }
+    AnalyzerConfig getAnalyzerConfig() const
+    {
+        AnalyzerConfig config;
+        for (;;)
+        {
+            const uint32_t sequence = analyzerConfigSequence.load(std::memory_order_acquire);
+            if ((sequence & 1u) != 0)
+            {
+                continue;
+            }
+            config.sampleRate = analyzerSampleRate.load(std::memory_order_relaxed);
+            config.blockSize = analyzerBlockSize.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (analyzerConfigSequence.load(std::memory_order_relaxed) == sequence)
             {
-                updateFlags.fetch_or(1 << (bandNum - 1));
+                config.version = sequence >> 1;
+                return config;
             }
         }
-    };
-    SingleChannelSampleFifo leftChannelFifo {Channel::Left};
-    SingleChannelSampleFifo rightChannelFifo {Channel::Right};
+    }
+#if QUASAR_PROFILING
+    StageProfiler& getProfiler()
+    {
+        return profiler;
+    }
+#endif
+    CoefficientCache& getCoefficientCache()
+    {
+        return *coefficientCache;
+    }
+    AnalyzerJob& getAnalyzerJob()
+    {
+        return analyzerJob;
+    }
+    void setAnalyzerEnabled(bool shouldBeEnabled)
+    {
+        analyzerEnabled.store(shouldBeEnabled, std::memory_order_relaxed);
+    }
+    void startSpectrumCapture(int slot)
+    {
+        auto& capture = spectrumCaptures[static_cast<size_t>(slot)];
+        capture.reset();
+        capturingSlot = slot;
+        analyzerJob.getPathProducer().setSpectrumCapture(&capture);
+    }
+    void stopSpectrumCapture()
+    {
+        capturingSlot = -1;
+        analyzerJob.getPathProducer().setSpectrumCapture(nullptr);
+    }
+    int getCapturingSlot() const
+    {
+        return capturingSlot;
+    }
+    const LongTermSpectrum& getSpectrumCapture(int slot) const
+    {
+        return spectrumCaptures[static_cast<size_t>(slot)];
+    }
+    bool matchSpectrum()
+    {
+        const auto& reference = spectrumCaptures[CAPTURE_REFERENCE];
+        const auto& target = spectrumCaptures[CAPTURE_TARGET];
+        if (reference.getNumFrames() == 0 || target.getNumFrames() == 0)
+        {
+            return false;
+        }
+        const double sr = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+        applyMatchedBands(fitSpectrum(reference.getDecibels(), target.getDecibels(), sr));
+        return true;
+    }
+    static std::array<MatchedBand, NUM_BANDS> fitSpectrum(const std::vector<float>& reference, const std::vector<float>& target, double sampleRate)
+    {
+        SpectrumMatcher<NUM_BANDS> matcher(sampleRate, {FREQ_START, FREQ_END, GAIN_START, GAIN_END, QUAL_START, QUAL_END});
+        return matcher.fit(reference, target);
+    }
+    void applyMatchedBands(const std::array<MatchedBand, NUM_BANDS>& matched)
+    {
+        auto state = captureState();
+        for (int i = 0; i < NUM_BANDS; ++i)
+        {
+            const auto& source = matched[static_cast<size_t>(i)];
+            const auto& target = bandParameters[i];
+            auto& band = state.bands[static_cast<size_t>(i)];
+            band.type = static_cast<juce::uint8>(source.type);
+            band.freq = snapToParameter(target.freq, source.freq);
+            band.gain = snapToParameter(target.gain, source.gain);
+            band.q = snapToParameter(target.q, source.q);
+            band.bypass = source.enabled ? 0 : 1;
+            band.slope = 0;
+            band.dynamic = 0;
+        }
+        recallSnapshot(state);
+    }
+    bool setSharedExportEnabled(bool shouldBeEnabled)
+    {
+        auto& pathProducer = analyzerJob.getPathProducer();
+        if (!shouldBeEnabled)
+        {
+            pathProducer.setSharedExport(nullptr);
+            analyzerJob.waitUntilIdle();
+            sharedExport.close();
+            return true;
+        }
+        if (!sharedExport.isOpen() && !sharedExport.open(pathProducer.makeBinLUT(), PathProducer::getFFTSize()))
+        {
+            return false;
+        }
+        pathProducer.setSharedExport(&sharedExport);
+        return true;
+    }
+    const juce::String& getSharedExportName() const
+    {
+        return sharedExport.getName();
+    }
+    SimdIsa getSimdIsa() const
+    {
+        return simdIsa;
+    }
+    MemoryFootprint getMemoryFootprint() const
+    {
+        using Bank = decltype(filterBank);
+        MemoryFootprint footprint;
+        footprint.instanceBytes = sizeof(*this);
+        footprint.hotBytes = Bank::getHotBytes() + sizeof(dynamicEq) + sizeof(outGain);
+        footprint.activeCacheLines = filterBank.getActiveCacheLines() + Bank::getCacheLines(sizeof(outGain)) + (dynamicEq.isActive() ? Bank::getCacheLines(sizeof(dynamicEq)) : 0);
+        footprint.heapBytes = filterBank.getHeapBytes() + parameterRoutes.capacity() * sizeof(uint32_t);
+        return footprint;
+    }
+    bool hasDynamicBands() const
+    {
+        return dynamicEq.isActive();
+    }
+    juce::int64 computeTailSamples(double sampleRate, double decayThreshold) const
+    {
+        const double maxTailSamples = MAX_TAIL_SECONDS * sampleRate;
+        double total = 0.0;
+        for (int i = 0; i < NUM_BANDS; ++i)
+        {
+            if (filterBank.isBypassed(i))
+            {
+                continue;
+            }
+            for (int section = 0; section < filterBank.getNumSections(i); ++section)
+            {
+                const double radius = filterBank.getPoleRadius(i, section);
+                if (radius >= 1.0)
+                {
+                    return static_cast<juce::int64>(maxTailSamples);
+                }
+                if (radius > 0.0)
+                {
+                    total += std::ceil(std::log(decayThreshold) / std::log(radius));
+                }
+            }
+        }
+        return static_cast<juce::int64>(juce::jmin(total, maxTailSamples));
+    }
+    SingleChannelSampleFifo leftChannelFifo;
+    SingleChannelSampleFifo rightChannelFifo;
     juce::AudioProcessorValueTreeState apvts;
 private:
     static constexpr uint32_t ALL_BANDS_MASK = (1u << NUM_BANDS) - 1;
-    static constexpr uint32_t GLOBAL_PARAMS_MASK = (1u << NUM_BANDS);
-    static constexpr uint32_t ALL_UPDATE_MASK = ALL_BANDS_MASK | GLOBAL_PARAMS_MASK;
-    FilterChain<NUM_BANDS> filterChain;
+    static constexpr uint32_t BYPASS_FLAG = (1u << NUM_BANDS);
+    static constexpr uint32_t GAIN_FLAG = (1u << (NUM_BANDS + 1));
+    static constexpr uint32_t ALL_UPDATE_MASK = ALL_BANDS_MASK | BYPASS_FLAG | GAIN_FLAG;
+    std::array<BandParameters, NUM_BANDS> bandParameters;
+    juce::AudioParameterFloat* gainParameter = nullptr;
+    juce::AudioParameterBool* globalBypassParameter = nullptr;
+    std::vector<uint32_t> parameterRoutes;
+    juce::AudioParameterChoice* analyzerTapParameter = nullptr;
+    juce::AudioParameterBool* idleSleepParameter = nullptr;
+    juce::AudioParameterBool* snapshotFadeParameter = nullptr;
+    SnapshotExchange<PresetSnapshot<NUM_BANDS>> snapshots;
+    std::array<BinaryState<NUM_BANDS>, NUM_SNAPSHOT_SLOTS> snapshotSlots;
+    std::array<bool, NUM_SNAPSHOT_SLOTS> snapshotSlotStored {};
+    int activeSnapshotSlot = 0;
+    std::atomic<double> tailSeconds {0.0};
+    MultiChannelFilterBank<NUM_BANDS, MAX_CHANNELS> filterBank;
+    DynamicEq<NUM_BANDS> dynamicEq;
     juce::dsp::ProcessorChain<juce::dsp::Gain<T>> outGain;
-    std::atomic<uint32_t> updateFlags {ALL_UPDATE_MASK};
+    std::array<std::array<uint32_t, 2>, 2> analyzerTapMasks {{{1u, 2u}, {1u, 2u}}};
+    juce::int64 tailSamples = 0;
+    juce::int64 silentSamples = 0;
+    int svfGlideSamples = 0;
+    bool sleeping = false;
+    SimdIsa simdIsa = SimdIsa::Sse2;
+    alignas(64) std::atomic<uint32_t> updateFlags {ALL_UPDATE_MASK};
+    std::atomic<uint32_t> parameterVersion {0};
+    std::atomic<int> parameterBatchDepth {0};
+    std::atomic<bool> precisionChanged {false};
+    std::atomic<bool> analyzerEnabled {true};
+    std::atomic<juce::Thread::ThreadID> recallThread {nullptr};
+    std::atomic<uint32_t> analyzerConfigSequence {0};
+    std::atomic<double> analyzerSampleRate {44100.0};
+    std::atomic<int> analyzerBlockSize {0};
+    std::unique_ptr<juce::SharedResourcePointer<SharedEditorResources>> editorResources;
+    juce::SharedResourcePointer<CoefficientCache> coefficientCache;
+#if QUASAR_PROFILING
+    StageProfiler profiler;
+#endif
+    std::array<LongTermSpectrum, NUM_SPECTRUM_CAPTURES> spectrumCaptures;
+    int capturingSlot = -1;
+    SharedSpectrumExport sharedExport;
+    AnalyzerJob analyzerJob {leftChannelFifo, rightChannelFifo, [this] { return getAnalyzerConfig(); }};
+    void publishAnalyzerConfig(double sampleRate, int samplesPerBlock)
+    {
+        analyzerConfigSequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        analyzerSampleRate.store(sampleRate, std::memory_order_relaxed);
+        analyzerBlockSize.store(samplesPerBlock, std::memory_order_relaxed);
+        analyzerConfigSequence.fetch_add(1, std::memory_order_release);
+    }
+    void prepareAnalyzerTaps(const juce::AudioChannelSet& layout)
+    {
+        const int numChannels = juce::jmin(layout.size(), MAX_CHANNELS);
+        const uint32_t allChannels = (1u << numChannels) - 1u;
+        if (numChannels < 2)
+        {
+            analyzerTapMasks = {{{allChannels, allChannels}, {allChannels, allChannels}}};
+            return;
+        }
+        uint32_t leftSide = 0;
+        uint32_t rightSide = 0;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            switch (layout.getTypeOfChannel(ch))
+            {
+                case juce::AudioChannelSet::left:
+                case juce::AudioChannelSet::leftCentre:
+                case juce::AudioChannelSet::leftSurround:
+                case juce::AudioChannelSet::leftSurroundSide:
+                case juce::AudioChannelSet::leftSurroundRear:
+                case juce::AudioChannelSet::wideLeft:
+                case juce::AudioChannelSet::topFrontLeft:
+                case juce::AudioChannelSet::topSideLeft:
+                case juce::AudioChannelSet::topRearLeft:
+                    leftSide |= 1u << ch;
+                    break;
+                case juce::AudioChannelSet::right:
+                case juce::AudioChannelSet::rightCentre:
+                case juce::AudioChannelSet::rightSurround:
+                case juce::AudioChannelSet::rightSurroundSide:
+                case juce::AudioChannelSet::rightSurroundRear:
+                case juce::AudioChannelSet::wideRight:
+                case juce::AudioChannelSet::topFrontRight:
+                case juce::AudioChannelSet::topSideRight:
+                case juce::AudioChannelSet::topRearRight:
+                    rightSide |= 1u << ch;
+                    break;
+                default:
+                    leftSide |= 1u << ch;
+                    rightSide |= 1u << ch;
+                    break;
+            }
+        }
+        analyzerTapMasks[0] = {1u, 2u};
+        analyzerTapMasks[1] = {leftSide, rightSide};
+    }
+    static float snapToParameter(const juce::RangedAudioParameter* parameter, float value)
+    {
+        return parameter->convertFrom0to1(parameter->convertTo0to1(value));
+    }
+    static void setParameter(juce::RangedAudioParameter* parameter, float value)
+    {
+        const float normalised = parameter->convertTo0to1(value);
+        if (parameter->getValue() != normalised)
+        {
+            parameter->setValueNotifyingHost(normalised);
+        }
+    }
+    BinaryState<NUM_BANDS> captureState() const
+    {
+        BinaryState<NUM_BANDS> state;
+        state.outGain = gainParameter->get();
+        state.bypass = globalBypassParameter->get() ? 1 : 0;
+        state.analyzerTap = static_cast<juce::uint8>(analyzerTapParameter->getIndex());
+        state.idleSleep = idleSleepParameter->get() ? 1 : 0;
+        state.snapshotFade = snapshotFadeParameter->get() ? 1 : 0;
+        for (int i = 0; i < NUM_BANDS; ++i)
+        {
+            state.bands[static_cast<size_t>(i)] = captureBand(i);
+        }
+        return state;
+    }
+    BinaryState<NUM_BANDS>::Band captureBand(int i) const
+    {
+        const auto& source = bandParameters[i];
+        BinaryState<NUM_BANDS>::Band band;
+        band.freq = source.freq->get();
+        band.gain = source.gain->get();
+        band.q = source.q->get();
+        band.type = static_cast<juce::uint8>(source.type->getIndex());
+        band.bypass = source.bypass->get() ? 1 : 0;
+        band.route = static_cast<juce::uint8>(source.route->getIndex());
+        band.topology = static_cast<juce::uint8>(source.topology->getIndex());
+        band.slope = static_cast<juce::uint8>(source.slope->getIndex());
+        band.dynamic = source.dynamic->get() ? 1 : 0;
+        band.threshold = source.threshold->get();
+        band.ratio = source.ratio->get();
+        band.attack = source.attack->get();
+        band.release = source.release->get();
+        return band;
+    }
+    static DynamicBandSettings getDynamicSettings(const BinaryState<NUM_BANDS>::Band& band, bool globalBypass)
+    {
+        DynamicBandSettings settings;
+        settings.enabled = band.dynamic != 0 && band.bypass == 0 && !globalBypass;
+        settings.type = juce::jlimit(0, filterTags.size() - 1, static_cast<int>(band.type));
+        settings.topology = static_cast<BandTopology>(juce::jlimit(0, topologyTags.size() - 1, static_cast<int>(band.topology)));
+        settings.routing = static_cast<BandRouting>(juce::jlimit(0, routeTags.size() - 1, static_cast<int>(band.route)));
+        settings.freq = band.freq;
+        settings.q = band.q;
+        settings.gain = band.gain;
+        settings.threshold = band.threshold;
+        settings.ratio = band.ratio;
+        settings.attack = band.attack;
+        settings.release = band.release;
+        return settings;
+    }
+    void processDynamicBands(juce::AudioBuffer<float>& buffer, int numInputChannels)
+    {
+        const int numSamples = buffer.getNumSamples();
+        const auto* left = buffer.getReadPointer(0);
+        const auto* right = numInputChannels > 1 ? buffer.getReadPointer(1) : left;
+        for (int start = 0; start < numSamples; start += DynamicEq<NUM_BANDS>::UPDATE_INTERVAL)
+        {
+            const int chunk = juce::jmin(DynamicEq<NUM_BANDS>::UPDATE_INTERVAL, numSamples - start);
+            dynamicEq.process(left + start, right + start, chunk);
+            dynamicEq.update([this](int band, const BiquadCoefficients& coefficients)
+            {
+                filterBank.glideTo(band, coefficients, DynamicEq<NUM_BANDS>::UPDATE_INTERVAL);
+            });
+            filterBank.process(buffer, start, chunk);
+        }
+    }
+    BinaryState<NUM_BANDS> captureDefaultState() const
+    {
+        const auto defaultOf = [](const juce::RangedAudioParameter* parameter)
+        {
+            return parameter->convertFrom0to1(parameter->getDefaultValue());
+        };
+        BinaryState<NUM_BANDS> state;
+        state.outGain = defaultOf(gainParameter);
+        state.bypass = defaultOf(globalBypassParameter) > 0.5f ? 1 : 0;
+        state.analyzerTap = static_cast<juce::uint8>(defaultOf(analyzerTapParameter));
+        state.idleSleep = defaultOf(idleSleepParameter) > 0.5f ? 1 : 0;
+        state.snapshotFade = defaultOf(snapshotFadeParameter) > 0.5f ? 1 : 0;
+        for (int i = 0; i < NUM_BANDS; ++i)
+        {
+            const auto& source = bandParameters[i];
+            auto& band = state.bands[static_cast<size_t>(i)];
+            band.freq = defaultOf(source.freq);
+            band.gain = defaultOf(source.gain);
+            band.q = defaultOf(source.q);
+            band.type = static_cast<juce::uint8>(defaultOf(source.type));
+            band.bypass = defaultOf(source.bypass) > 0.5f ? 1 : 0;
+            band.route = static_cast<juce::uint8>(defaultOf(source.route));
+            band.topology = static_cast<juce::uint8>(defaultOf(source.topology));
+            band.slope = static_cast<juce::uint8>(defaultOf(source.slope));
+            band.dynamic = defaultOf(source.dynamic) > 0.5f ? 1 : 0;
+            band.threshold = defaultOf(source.threshold);
+            band.ratio = defaultOf(source.ratio);
+            band.attack = defaultOf(source.attack);
+            band.release = defaultOf(source.release);
+        }
+        return state;
+    }
+    template <typename Function>
+    void visitState(const BinaryState<NUM_BANDS>& state, Function&& function) const
+    {
+        function(gainParameter, state.outGain);
+        function(globalBypassParameter, state.bypass != 0 ? 1.0f : 0.0f);
+        function(analyzerTapParameter, static_cast<float>(state.analyzerTap));
+        function(idleSleepParameter, state.idleSleep != 0 ? 1.0f : 0.0f);
+        function(snapshotFadeParameter, state.snapshotFade != 0 ? 1.0f : 0.0f);
+        for (int i = 0; i < NUM_BANDS; ++i)
+        {
+            const auto& target = bandParameters[i];
+            const auto& band = state.bands[static_cast<size_t>(i)];
+            function(target.freq, band.freq);
+            function(target.gain, band.gain);
+            function(target.q, band.q);
+            function(target.type, static_cast<float>(band.type));
+            function(target.bypass, band.bypass != 0 ? 1.0f : 0.0f);
+            function(target.route, static_cast<float>(band.route));
+            function(target.topology, static_cast<float>(band.topology));
+            function(target.slope, static_cast<float>(band.slope));
+            function(target.dynamic, band.dynamic != 0 ? 1.0f : 0.0f);
+            function(target.threshold, band.threshold);
+            function(target.ratio, band.ratio);
+            function(target.attack, band.attack);
+            function(target.release, band.release);
+        }
+    }
+    void applyState(const BinaryState<NUM_BANDS>& state, uint32_t flags)
+    {
+        beginParameterBatch();
+        visitState(state, [](juce::RangedAudioParameter* parameter, float value)
+        {
+            setParameter(parameter, value);
+        });
+        endParameterBatch(flags);
+    }
+    uint32_t getStateRoutes(const BinaryState<NUM_BANDS>& state) const
+    {
+        uint32_t routes = 0;
+        visitState(state, [this, &routes](juce::RangedAudioParameter* parameter, float value)
+        {
+            if (parameter->getValue() != parameter->convertTo0to1(value))
+            {
+                routes |= parameterRoutes[static_cast<size_t>(parameter->getParameterIndex())];
+            }
+        });
+        return routes;
+    }
+    void applySnapshot(const PresetSnapshot<NUM_BANDS>& snapshot)
+    {
+        const double sr = getSampleRate();
+        if (snapshot.sampleRate != sr)
+        {
+            updateFlags.fetch_or(ALL_UPDATE_MASK);
+            return;
+        }
+        const int fadeSamples = snapshotFadeParameter->get() ? juce::roundToInt(SNAPSHOT_FADE_SECONDS * sr) : 0;
+        for (int i = 0; i < NUM_BANDS; ++i)
+        {
+            const auto topology = snapshot.topologies[static_cast<size_t>(i)];
+            filterBank.setRouting(i, snapshot.routings[static_cast<size_t>(i)]);
+            if (filterBank.getTopology(i) != topology)
+            {
+                filterBank.setTopology(i, topology);
+                filterBank.setCoefficients(i, snapshot.coefficients[static_cast<size_t>(i)]);
+                filterBank.setBypassed(i, snapshot.bypassed[static_cast<size_t>(i)]);
+                continue;
+            }
+            filterBank.fadeTo(i, snapshot.coefficients[static_cast<size_t>(i)], snapshot.bypassed[static_cast<size_t>(i)], fadeSamples);
+        }
+        for (int i = 0; i < NUM_BANDS; ++i)
+        {
+            dynamicEq.configure(i, snapshot.dynamics[static_cast<size_t>(i)]);
+        }
+        updateTailLength(sr);
+        outGain.setBypassed<0>(snapshot.globalBypass);
+        outGain.get<0>().setRampDurationSeconds(fadeSamples > 0 ? SNAPSHOT_FADE_SECONDS : 0.0);
+        outGain.get<0>().setGainDecibels(snapshot.gainDecibels);
+    }
+    static bool isSilent(const juce::AudioBuffer<float>& buffer, int numChannels)
+    {
+        for (int ch = 0; ch < juce::jmin(numChannels, buffer.getNumChannels()); ++ch)
+        {
+            const auto range = buffer.findMinMax(ch, 0, buffer.getNumSamples());
+            if (range.getStart() < -SILENCE_THRESHOLD || range.getEnd() > SILENCE_THRESHOLD)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    void updateTailLength(double sampleRate)
+    {
+        tailSamples = computeTailSamples(sampleRate, TAIL_DECAY_THRESHOLD);
+        tailSeconds.store(static_cast<double>(tailSamples) / sampleRate, std::memory_order_relaxed);
+    }
+    CacheCounters* getCacheCounters() noexcept
+    {
+#if QUASAR_PROFILING
+        return &profiler.getCacheCounters();
+#else
+        return nullptr;
+#endif
+    }
+    uint32_t findParameterRoute(const juce::AudioProcessorParameter* parameter) const
+    {
+        if (parameter == gainParameter)
+        {
+            return GAIN_FLAG;
+        }
+        if (parameter == globalBypassParameter)
+        {
+            return BYPASS_FLAG;
+        }
+        for (int i = 0; i < NUM_BANDS; ++i)
+        {
+            const auto& band = bandParameters[i];
+            if (parameter == band.bypass)
+            {
+                return BYPASS_FLAG;
+            }
+            if (parameter == band.freq || parameter == band.gain || parameter == band.q || parameter == band.type || parameter == band.route || parameter == band.topology
+                || parameter == band.slope || parameter == band.dynamic || parameter == band.threshold || parameter == band.ratio || parameter == band.attack || parameter == band.release)
+            {
+                return 1u << i;
+            }
+        }
+        return 0;
+    }
     void updateFilters(uint32_t flags)
     {
         if (flags == 0) return;
         const auto sr = getSampleRate();
-        const bool globalBypass = static_cast<bool>(apvts.getRawParameterValue(ID_GLOBAL_BYPASS)->load());
+        const bool globalBypass = globalBypassParameter->get();
         for (int i = 0; i < NUM_BANDS; ++i)
         {
-            if ((flags & (1 << i)) || (flags & GLOBAL_PARAMS_MASK))
+            const auto& band = bandParameters[i];
+            if (flags & ((1u << i) | BYPASS_FLAG))
             {
-                const juce::String idx = juce::String(i + 1);
-                const auto bandF = juce::jmin(apvts.getRawParameterValue(ID_PREFIX_FREQ + idx)->load(), static_cast<float>(sr * 0.49));
-                const auto bandQ = apvts.getRawParameterValue(ID_PREFIX_Q + idx)->load();
-                const auto bandG = juce::Decibels::decibelsToGain(apvts.getRawParameterValue(ID_PREFIX_GAIN + idx)->load());
-                const auto bandT = static_cast<int>(apvts.getRawParameterValue(ID_PREFIX_TYPE + idx)->load());
-                auto newCoefs = filterFactories[bandT](sr, bandF, bandQ, bandG);
-                const bool individualBypass = static_cast<bool>(apvts.getRawParameterValue(ID_PREFIX_BYPASS + idx)->load());
-                updateProcessorAtIndex(i, newCoefs, globalBypass || individualBypass);
+                dynamicEq.configure(i, getDynamicSettings(captureBand(i), globalBypass));
             }
+            if (flags & (1u << i))
+            {
+                const auto bandF = juce::jmin(band.freq->get(), static_cast<float>(sr * 0.49));
+                const auto bandQ = band.q->get();
+                const auto bandT = band.type->getIndex();
+                const auto topology = static_cast<BandTopology>(band.topology->getIndex());
+                const auto bandG = dynamicEq.isDynamic(i) ? band.gain->get() - dynamicEq.getGainReduction(i) : band.gain->get();
+                const auto coefficients = coefficientCache->getCascade(topology, bandT, band.slope->getIndex(), sr, bandF, bandQ, bandG, getCacheCounters());
+                filterBank.setRouting(i, static_cast<BandRouting>(band.route->getIndex()));
+                if (topology == BandTopology::Svf && filterBank.getTopology(i) == topology)
+                {
+                    filterBank.glideTo(i, coefficients, svfGlideSamples);
+                }
+                else
+                {
+                    filterBank.setTopology(i, topology);
+                    filterBank.setCoefficients(i, coefficients);
+                }
+            }
+            if (flags & BYPASS_FLAG)
+            {
+                filterBank.setBypassed(i, globalBypass || band.bypass->get());
+            }
+        }
+        if (flags & (ALL_BANDS_MASK | BYPASS_FLAG))
+        {
+            updateTailLength(sr);
+#if QUASAR_PROFILING
+            profiler.setMemoryFootprint(getMemoryFootprint());
+#endif
         }
-        if (flags & GLOBAL_PARAMS_MASK)
+        if (flags & BYPASS_FLAG)
         {
-            const auto g = apvts.getRawParameterValue(ID_GAIN)->load();
             outGain.setBypassed<0>(globalBypass);
-            outGain.get<0>().setGainDecibels(g);
+        }
+        if (flags & GAIN_FLAG)
+        {
+            outGain.get<0>().setRampDurationSeconds(0.0);
+            outGain.get<0>().setGainDecibels(gainParameter->get());
         }
     }
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout() const
@@ -235,9 +1021,19 @@ private:
         juce::NormalisableRange<float> qualRange {QUAL_START, QUAL_END, QUAL_INTERVAL};
         freqRange.setSkewForCentre(freqRange.snapToLegalValue(FREQ_CENTRE));
         qualRange.setSkewForCentre(qualRange.snapToLegalValue(QUAL_CENTRE));
+        juce::NormalisableRange<float> thresholdRange {THRESHOLD_START, THRESHOLD_END, THRESHOLD_INTERVAL};
+        juce::NormalisableRange<float> ratioRange {RATIO_START, RATIO_END, RATIO_INTERVAL};
+        juce::NormalisableRange<float> attackRange {ATTACK_START, ATTACK_END, ATTACK_INTERVAL};
+        juce::NormalisableRange<float> releaseRange {RELEASE_START, RELEASE_END, RELEASE_INTERVAL};
+        ratioRange.setSkewForCentre(RATIO_CENTRE);
+        attackRange.setSkewForCentre(ATTACK_CENTRE);
+        releaseRange.setSkewForCentre(RELEASE_CENTRE);
         juce::AudioProcessorValueTreeState::ParameterLayout layout;
         layout.add(std::make_unique<juce::AudioParameterBool>(ID_GLOBAL_BYPASS, NAME_GLOBAL_BYPASS, GLOBAL_BYPASS_DEFAULT));
         layout.add(std::make_unique<juce::AudioParameterFloat>(ID_GAIN, NAME_GAIN, gainRange, GAIN_CENTRE, UNIT_DB));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(ID_ANALYZER_TAP, NAME_ANALYZER_TAP, analyzerTapTags, ANALYZER_TAP_DEFAULT, juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+        layout.add(std::make_unique<juce::AudioParameterBool>(ID_IDLE_SLEEP, NAME_IDLE_SLEEP, IDLE_SLEEP_DEFAULT, juce::AudioParameterBoolAttributes().withAutomatable(false)));
+        layout.add(std::make_unique<juce::AudioParameterBool>(ID_SNAPSHOT_FADE, NAME_SNAPSHOT_FADE, SNAPSHOT_FADE_DEFAULT, juce::AudioParameterBoolAttributes().withAutomatable(false)));
         for (int i = 0; i < NUM_BANDS; ++i)
         {
             const juce::String index = juce::String(i + 1);
@@ -246,24 +1042,15 @@ private:
             layout.add(std::make_unique<juce::AudioParameterFloat>(ID_PREFIX_GAIN + index, NAME_PREFIX_BAND + index + NAME_PREFIX_GAIN, gainRange, GAIN_CENTRE, UNIT_DB));
             layout.add(std::make_unique<juce::AudioParameterFloat>(ID_PREFIX_Q + index, NAME_PREFIX_BAND + index + NAME_PREFIX_Q, qualRange, qualRange.snapToLegalValue(QUAL_CENTRE)));
             layout.add(std::make_unique<juce::AudioParameterChoice>(ID_PREFIX_TYPE + index, NAME_PREFIX_BAND + index + NAME_PREFIX_TYPE, filterTags, TYPE_DEFAULT));
+            layout.add(std::make_unique<juce::AudioParameterChoice>(ID_PREFIX_ROUTE + index, NAME_PREFIX_BAND + index + NAME_PREFIX_ROUTE, routeTags, ROUTE_DEFAULT));
+            layout.add(std::make_unique<juce::AudioParameterChoice>(ID_PREFIX_TOPOLOGY + index, NAME_PREFIX_BAND + index + NAME_PREFIX_TOPOLOGY, topologyTags, TOPOLOGY_DEFAULT));
+            layout.add(std::make_unique<juce::AudioParameterChoice>(ID_PREFIX_SLOPE + index, NAME_PREFIX_BAND + index + NAME_PREFIX_SLOPE, slopeTags, SLOPE_DEFAULT));
+            layout.add(std::make_unique<juce::AudioParameterBool>(ID_PREFIX_DYNAMIC + index, NAME_PREFIX_BAND + index + NAME_PREFIX_DYNAMIC, DYNAMIC_DEFAULT));
+            layout.add(std::make_unique<juce::AudioParameterFloat>(ID_PREFIX_THRESHOLD + index, NAME_PREFIX_BAND + index + NAME_PREFIX_THRESHOLD, thresholdRange, THRESHOLD_DEFAULT, UNIT_DB));
+            layout.add(std::make_unique<juce::AudioParameterFloat>(ID_PREFIX_RATIO + index, NAME_PREFIX_BAND + index + NAME_PREFIX_RATIO, ratioRange, RATIO_CENTRE));
+            layout.add(std::make_unique<juce::AudioParameterFloat>(ID_PREFIX_ATTACK + index, NAME_PREFIX_BAND + index + NAME_PREFIX_ATTACK, attackRange, ATTACK_CENTRE, UNIT_MS));
+            layout.add(std::make_unique<juce::AudioParameterFloat>(ID_PREFIX_RELEASE + index, NAME_PREFIX_BAND + index + NAME_PREFIX_RELEASE, releaseRange, RELEASE_CENTRE, UNIT_MS));
         }
         return layout;
     };
-    template <size_t I>
-    void updateSpecificFilter(int targetIndex, juce::dsp::IIR::Coefficients<T>::Ptr newCoefs, bool bypassed)
-    {
-        if (targetIndex == static_cast<int>(I))
-        {
-            *filterChain.get<I>().state = *newCoefs;
-            filterChain.setBypassed<I>(bypassed);
-        }
-        if constexpr (I + 1 < NUM_BANDS)
-        {
-            updateSpecificFilter<I + 1>(targetIndex, newCoefs, bypassed);
-        }
-    }
-    void updateProcessorAtIndex(int index, juce::dsp::IIR::Coefficients<T>::Ptr newCoefs, bool bypassed)
-    {
-        updateSpecificFilter<0>(index, newCoefs, bypassed);
-    }
 };
@@ -0,0 +1,520 @@
+#pragma once
+
+#include <array>
+#include <deque>
+#include <functional>
+#include <JuceHeader.h>
+#include "QFifo.h"
+#include "QSpectrumMatch.h"
+#include "QSharedExport.h"
+#include "QSimdKernels.h"
+struct AnalyzerConfig
+{
+    double sampleRate = 44100.0;
+    int blockSize = 0;
+    uint32_t version = 0;
+};
+struct SpectrumRenderData
+{
+    std::vector<float> spectrumPath;
+    std::vector<float> peakHoldPath;
+    float leftDB = -100.0f;
+    float rightDB = -100.0f;
+};
+class PathProducer
+{
+public:
+    PathProducer(SingleChannelSampleFifo& leftScsf, SingleChannelSampleFifo& rightScsf): leftChannelFifo(&leftScsf), rightChannelFifo(&rightScsf)
+    {
+        fftBuffer.setSize(1, FFT_OUT_SIZE, false, true, true);
+        monoBufferL.setSize(1, FFT_SIZE, false, true, true);
+        monoBufferR.setSize(1, FFT_SIZE, false, true, true);
+        monoAverageBuffer.setSize(1, FFT_SIZE, false, true, true);
+        leftIncomingBuffer.setSize(1, SingleChannelSampleFifo::HOP_SIZE, false, true, true);
+        rightIncomingBuffer.setSize(1, SingleChannelSampleFifo::HOP_SIZE, false, true, true);
+        peakFallVelocity.assign(RENDER_OUT_SIZE, 0.0f);
+        peakHoldDecibels.assign(RENDER_OUT_SIZE, -std::numeric_limits<float>::infinity());
+        currentDecibels.assign(RENDER_OUT_SIZE, -std::numeric_limits<float>::infinity());
+        Gains.assign(RENDER_OUT_SIZE, 0.0f);
+        SmoothGains.assign(RENDER_OUT_SIZE, 0.0f);
+    };
+    void process(const AnalyzerConfig& config)
+    {
+        if (config.version != preparedConfigVersion || discarded)
+        {
+            reset();
+            preparedConfigVersion = config.version;
+            discarded = false;
+        }
+        const double sampleRate = config.sampleRate;
+        const auto kernels = SimdDispatch::getAnalyzerKernels(simdIsa.load(std::memory_order_relaxed));
+        bool aaa = false;
+        while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0 && rightChannelFifo->getNumCompleteBuffersAvailable() > 0)
+        {
+            if (leftChannelFifo->getAudioBuffer(leftIncomingBuffer) && rightChannelFifo->getAudioBuffer(rightIncomingBuffer))
+            {
+                aaa = true;
+                const int incomingSize = leftIncomingBuffer.getNumSamples();
+                currentLeftGain = kernels.findPeak(leftIncomingBuffer.getReadPointer(0), incomingSize);
+                currentRightGain = kernels.findPeak(rightIncomingBuffer.getReadPointer(0), incomingSize);
+                const int copySize = FFT_SIZE - incomingSize;
+                monoBufferL.copyFrom(0, 0, monoBufferL.getReadPointer(0, incomingSize), copySize);
+                monoBufferR.copyFrom(0, 0, monoBufferR.getReadPointer(0, incomingSize), copySize);
+                monoBufferL.copyFrom(0, copySize, leftIncomingBuffer.getReadPointer(0), incomingSize);
+                monoBufferR.copyFrom(0, copySize, rightIncomingBuffer.getReadPointer(0), incomingSize);
+                auto* destData = monoAverageBuffer.getWritePointer(0);
+                juce::FloatVectorOperations::copy(destData, monoBufferL.getReadPointer(0), FFT_SIZE);
+                juce::FloatVectorOperations::add(destData, monoBufferR.getReadPointer(0), FFT_SIZE);
+                juce::FloatVectorOperations::multiply(destData, 0.5f, FFT_SIZE);
+                auto* fftDataWritePointer = fftBuffer.getWritePointer(0);
+                juce::FloatVectorOperations::clear(fftDataWritePointer, FFT_OUT_SIZE);
+                juce::FloatVectorOperations::copy(fftDataWritePointer, monoAverageBuffer.getReadPointer(0), FFT_SIZE);
+                windowing.multiplyWithWindowingTable(fftDataWritePointer, FFT_SIZE);
+                fft.performFrequencyOnlyForwardTransform(fftDataWritePointer);
+                juce::FloatVectorOperations::multiply(fftDataWritePointer, fftDataWritePointer, INVERSE_NUM_BINS, NUM_BINS);
+                if (auto* capture = spectrumCapture.load(std::memory_order_acquire))
+                {
+                    capture->addFrame(fftDataWritePointer, NUM_BINS, sampleRate);
+                }
+                generatePath(kernels, fftDataWritePointer, static_cast<float>(incomingSize) / sampleRate);
+            }
+        }
+        if (aaa)
+        {
+            pathFifo.push({currentDecibels, peakHoldDecibels, juce::Decibels::gainToDecibels(smoothedLeftGain), juce::Decibels::gainToDecibels(smoothedRightGain)});
+            if (auto* destination = sharedExport.load())
+            {
+                destination->publish(currentDecibels.data(), peakHoldDecibels.data(), juce::Decibels::gainToDecibels(smoothedLeftGain), juce::Decibels::gainToDecibels(smoothedRightGain), sampleRate);
+            }
+        }
+    };
+    bool hasWork() const
+    {
+        return leftChannelFifo->getNumCompleteBuffersAvailable() > 0 && rightChannelFifo->getNumCompleteBuffersAvailable() > 0;
+    }
+    bool hasConsumer() const
+    {
+        return spectrumCapture.load(std::memory_order_acquire) != nullptr || sharedExport.load() != nullptr;
+    }
+    void discard()
+    {
+        if (leftChannelFifo->discard() + rightChannelFifo->discard() > 0)
+        {
+            discarded = true;
+        }
+    }
+    int getNumPathsAvailable() const
+    {
+        return pathFifo.getNumAvailableForReading();
+    }
+    ;
+    bool getPath(SpectrumRenderData& path)
+    {
+        return pathFifo.pull(path);
+    };
+    void setSpectrumCapture(LongTermSpectrum* capture)
+    {
+        spectrumCapture.store(capture, std::memory_order_release);
+    }
+    void setSharedExport(SharedSpectrumExport* destination)
+    {
+        sharedExport.store(destination);
+    }
+    void setSimdIsa(SimdIsa isa)
+    {
+        simdIsa.store(isa, std::memory_order_relaxed);
+    }
+    void reset()
+    {
+        monoBufferL.clear();
+        monoBufferR.clear();
+        std::fill(peakFallVelocity.begin(), peakFallVelocity.end(), 0.0f);
+        std::fill(peakHoldDecibels.begin(), peakHoldDecibels.end(), -std::numeric_limits<float>::infinity());
+        std::fill(currentDecibels.begin(), currentDecibels.end(), -std::numeric_limits<float>::infinity());
+        std::fill(Gains.begin(), Gains.end(), 0.0f);
+        std::fill(SmoothGains.begin(), SmoothGains.end(), 0.0f);
+        smoothedLeftGain = 0.0f;
+        smoothedRightGain = 0.0f;
+    };
+    std::vector<float> makeFreqLUT(const double sampleRate, const float minHz, const float maxHz) const
+    {
+        std::vector<float> frequencyLUT;
+        frequencyLUT.reserve(RENDER_OUT_SIZE);
+        const float binWidth = static_cast<float>(sampleRate / FFT_SIZE);
+        for (int levelIndex = 0, sourceDataIndex = 0, outputIndex = 0; levelIndex < NUM_SECTIONS; ++levelIndex)
+        {
+            const int windowSize = 1 << levelIndex;
+            const int nextOutputStart = outputIndex + (SECTION_SIZE >> levelIndex);
+            for (; outputIndex < nextOutputStart; ++outputIndex)
+            {
+
+                frequencyLUT.push_back(juce::mapFromLog10((binWidth * sourceDataIndex), minHz, maxHz));
+                sourceDataIndex += windowSize;
+            }
+        }
+        return frequencyLUT;
+    };
+    std::vector<int> makeBinLUT() const
+    {
+        std::vector<int> binLUT;
+        binLUT.reserve(RENDER_OUT_SIZE);
+        for (int levelIndex = 0, sourceDataIndex = 0, outputIndex = 0; levelIndex < NUM_SECTIONS; ++levelIndex)
+        {
+            const int windowSize = 1 << levelIndex;
+            const int nextOutputStart = outputIndex + (SECTION_SIZE >> levelIndex);
+            for (; outputIndex < nextOutputStart; ++outputIndex)
+            {
+                binLUT.push_back(sourceDataIndex);
+                sourceDataIndex += windowSize;
+            }
+        }
+        return binLUT;
+    }
+    static constexpr int getFFTSize()
+    {
+        return FFT_SIZE;
+    }
+private:
+    static constexpr int FFT_ORDER = 12;
+    static constexpr int NUM_SECTIONS = 1 << 3;
+    static constexpr int SECTION_SIZE = 1 << 8;
+    static constexpr int NUM_BINS = 1 << (FFT_ORDER - 1);
+    static constexpr int FFT_SIZE = 1 << FFT_ORDER;
+    static constexpr int FFT_OUT_SIZE = 1 << (FFT_ORDER + 1);
+    static constexpr int RENDER_OUT_SIZE = 510;
+    static constexpr float INVERSE_NUM_BINS = 1.0f / (1 << (FFT_ORDER - 1));
+    static constexpr float SMOOTHING_TIME_CONSTANT = 0.02f;
+    static constexpr float PEAK_DECAY_RATE = 80.0f;
+    static constexpr float LEVEL_METER_SMOOTHING_TIME_CONSTANT = SMOOTHING_TIME_CONSTANT * 5.0f;
+    SingleChannelSampleFifo* leftChannelFifo;
+    SingleChannelSampleFifo* rightChannelFifo;
+    juce::AudioBuffer<float> monoBufferL;
+    juce::AudioBuffer<float> monoBufferR;
+    juce::AudioBuffer<float> fftBuffer;
+    juce::AudioBuffer<float> monoAverageBuffer;
+    juce::AudioBuffer<float> leftIncomingBuffer;
+    juce::AudioBuffer<float> rightIncomingBuffer;
+    juce::dsp::FFT fft {FFT_ORDER};
+    juce::dsp::WindowingFunction<float> windowing {size_t(FFT_SIZE), juce::dsp::WindowingFunction<float>::blackmanHarris, true};
+    std::vector<float> peakFallVelocity;
+    std::vector<float> peakHoldDecibels;
+    std::vector<float> Gains;
+    std::vector<float> SmoothGains;
+    std::vector<float> currentDecibels;
+    float currentLeftGain = 0.0f;
+    float currentRightGain = 0.0f;
+    float smoothedLeftGain = 0.0f;
+    float smoothedRightGain = 0.0f;
+    uint32_t preparedConfigVersion = 0;
+    bool discarded = false;
+    Fifo<SpectrumRenderData> pathFifo;
+    std::atomic<LongTermSpectrum*> spectrumCapture {nullptr};
+    std::atomic<SharedSpectrumExport*> sharedExport {nullptr};
+    std::atomic<SimdIsa> simdIsa {SimdIsa::Sse2};
+    static_assert(RENDER_OUT_SIZE == SharedExportLayout::NUM_POINTS, "shared export layout must match the rendered spectrum");
+    void generatePath(const AnalyzerKernels& kernels, const float* renderData, const float deltaTime)
+    {
+        for (int levelIndex = 0, sourceDataIndex = 0, outputIndex = 0; levelIndex < NUM_SECTIONS; ++levelIndex)
+        {
+            const int windowSize = 1 << levelIndex;
+            const int count = SECTION_SIZE >> levelIndex;
+            kernels.findMaxima(renderData + sourceDataIndex, Gains.data() + outputIndex, count, windowSize);
+            sourceDataIndex += count * windowSize;
+            outputIndex += count;
+        }
+        const float peakFallRate = PEAK_DECAY_RATE * deltaTime;
+        const float alphaSmooth = 1.0f - std::exp(-deltaTime / SMOOTHING_TIME_CONSTANT);
+        const float oneMinusAlpha = 1.0f - alphaSmooth;
+        for (size_t i = 0; i < RENDER_OUT_SIZE; ++i)
+        {
+            if (SmoothGains[i] > Gains[i])
+            {
+                SmoothGains[i] = alphaSmooth * Gains[i] + oneMinusAlpha * SmoothGains[i];
+            }
+            else
+            {
+                SmoothGains[i] = Gains[i];
+            }
+            currentDecibels[i] = juce::Decibels::gainToDecibels(SmoothGains[i]);
+            peakFallVelocity[i] += peakFallRate;
+            peakHoldDecibels[i] -= peakFallVelocity[i] * deltaTime;
+            if (currentDecibels[i] >= peakHoldDecibels[i])
+            {
+                peakFallVelocity[i] = 0.0f;
+                peakHoldDecibels[i] = currentDecibels[i];
+            }
+        }
+        const float levelMeterAlphaSmooth = 1.0f - std::exp(-deltaTime / (LEVEL_METER_SMOOTHING_TIME_CONSTANT));
+        const float levelMeterOneMinusAlpha = 1.0f - levelMeterAlphaSmooth;
+        if (currentLeftGain < smoothedLeftGain)
+        {
+            smoothedLeftGain = levelMeterAlphaSmooth * currentLeftGain + levelMeterOneMinusAlpha * smoothedLeftGain;
+        }
+        else
+        {
+            smoothedLeftGain = currentLeftGain;
+        }
+        if (currentRightGain < smoothedRightGain)
+        {
+            smoothedRightGain = levelMeterAlphaSmooth * currentRightGain + levelMeterOneMinusAlpha * smoothedRightGain;
+        }
+        else
+        {
+            smoothedRightGain = currentRightGain;
+        }
+    };
+};
+class AnalyzerTask
+{
+public:
+    virtual ~AnalyzerTask() = default;
+    virtual bool hasWork() const = 0;
+    virtual bool isVisible() const = 0;
+    virtual bool isActive() const = 0;
+    virtual void run() = 0;
+    virtual void discard() = 0;
+    void waitUntilIdle() const
+    {
+        while (running.load())
+        {
+            juce::Thread::sleep(1);
+        }
+    }
+private:
+    friend class AnalyzerScheduler;
+    std::atomic<bool> queued {false};
+    std::atomic<bool> running {false};
+};
+class AnalyzerScheduler: private juce::Thread
+{
+public:
+    AnalyzerScheduler(): juce::Thread("Analyzer Dispatcher")
+    {
+        const int numWorkers = juce::jlimit(1, MAX_WORKERS, juce::SystemStats::getNumCpus() - 1);
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            workers.add(new Worker(*this, i));
+        }
+        for (auto* worker : workers)
+        {
+            worker->startThread(juce::Thread::Priority::low);
+        }
+        startThread(juce::Thread::Priority::low);
+    }
+    ~AnalyzerScheduler() override
+    {
+        stopThread(1000);
+        for (auto* worker : workers)
+        {
+            worker->signalThreadShouldExit();
+            worker->wake.signal();
+        }
+        for (auto* worker : workers)
+        {
+            worker->stopThread(1000);
+        }
+    }
+    void add(AnalyzerTask& task)
+    {
+        const juce::ScopedLock lock(registryLock);
+        tasks.addIfNotAlreadyThere(&task);
+    }
+    void remove(AnalyzerTask& task)
+    {
+        {
+            const juce::ScopedLock lock(registryLock);
+            tasks.removeFirstMatchingValue(&task);
+        }
+        for (auto* worker : workers)
+        {
+            const juce::ScopedLock lock(worker->queueLock);
+            for (auto& queue : worker->queues)
+            {
+                queue.erase(std::remove(queue.begin(), queue.end(), &task), queue.end());
+            }
+        }
+        task.waitUntilIdle();
+        task.queued.store(false, std::memory_order_release);
+    }
+    int getNumWorkers() const
+    {
+        return workers.size();
+    }
+    static constexpr int DISPATCH_INTERVAL = 20;
+private:
+    static constexpr int MAX_WORKERS = 4;
+    enum Priority
+    {
+        visible, background, numPriorities
+    };
+    class Worker: public juce::Thread
+    {
+    public:
+        Worker(AnalyzerScheduler& s, int i): juce::Thread("Analyzer Worker " + juce::String(i + 1)), scheduler(s), index(i)
+        {
+        }
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                if (auto* task = scheduler.take(index))
+                {
+                    task->run();
+                    scheduler.finish(*task);
+                    continue;
+                }
+                wake.wait(DISPATCH_INTERVAL);
+            }
+        }
+        AnalyzerScheduler& scheduler;
+        const int index;
+        juce::CriticalSection queueLock;
+        std::array<std::deque<AnalyzerTask*>, numPriorities> queues;
+        juce::WaitableEvent wake;
+    };
+    juce::OwnedArray<Worker> workers;
+    juce::CriticalSection registryLock;
+    juce::Array<AnalyzerTask*> tasks;
+    int nextWorker = 0;
+    static void finish(AnalyzerTask& task)
+    {
+        task.queued.store(false, std::memory_order_release);
+        task.running.store(false, std::memory_order_release);
+    }
+    AnalyzerTask* take(int index)
+    {
+        for (int priority = 0; priority < numPriorities; ++priority)
+        {
+            for (int offset = 0; offset < workers.size(); ++offset)
+            {
+                auto* worker = workers[(index + offset) % workers.size()];
+                const juce::ScopedLock lock(worker->queueLock);
+                auto& queue = worker->queues[static_cast<size_t>(priority)];
+                if (queue.empty())
+                {
+                    continue;
+                }
+                AnalyzerTask* task;
+                if (offset == 0)
+                {
+                    task = queue.front();
+                    queue.pop_front();
+                }
+                else
+                {
+                    task = queue.back();
+                    queue.pop_back();
+                }
+                task->running.store(true);
+                return task;
+            }
+        }
+        return nullptr;
+    }
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            {
+                const juce::ScopedLock lock(registryLock);
+                for (auto* task : tasks)
+                {
+                    if (!task->isActive())
+                    {
+                        if (task->hasWork() && !task->queued.exchange(true, std::memory_order_acq_rel))
+                        {
+                            task->discard();
+                            task->queued.store(false, std::memory_order_release);
+                        }
+                        continue;
+                    }
+                    const bool visibleTask = task->isVisible();
+                    if (!visibleTask && !task->hasWork())
+                    {
+                        continue;
+                    }
+                    if (task->queued.exchange(true, std::memory_order_acq_rel))
+                    {
+                        continue;
+                    }
+                    auto* worker = workers[nextWorker];
+                    nextWorker = (nextWorker + 1) % workers.size();
+                    {
+                        const juce::ScopedLock queueLock(worker->queueLock);
+                        worker->queues[static_cast<size_t>(visibleTask ? visible : background)].push_back(task);
+                    }
+                    worker->wake.signal();
+                }
+            }
+            wait(DISPATCH_INTERVAL);
+        }
+    }
+};
+class AnalyzerJob: public AnalyzerTask
+{
+public:
+    struct Client
+    {
+        virtual ~Client() = default;
+        virtual void analyzerJobFinished() = 0;
+    };
+    AnalyzerJob(SingleChannelSampleFifo& leftScsf, SingleChannelSampleFifo& rightScsf, std::function<AnalyzerConfig()> configSource): pathProducer(leftScsf, rightScsf), getConfig(std::move(configSource))
+    {
+        scheduler->add(*this);
+    }
+    ~AnalyzerJob() override
+    {
+        scheduler->remove(*this);
+    }
+    void setClient(Client* newClient)
+    {
+        const juce::ScopedLock lock(clientLock);
+        client = newClient;
+        attached.store(client != nullptr, std::memory_order_relaxed);
+        if (client == nullptr)
+        {
+            visible.store(false, std::memory_order_relaxed);
+        }
+    }
+    void setVisible(bool isNowVisible)
+    {
+        visible.store(isNowVisible, std::memory_order_relaxed);
+    }
+    bool hasWork() const override
+    {
+        return pathProducer.hasWork();
+    }
+    bool isVisible() const override
+    {
+        return visible.load(std::memory_order_relaxed);
+    }
+    bool isActive() const override
+    {
+        return attached.load(std::memory_order_relaxed) || pathProducer.hasConsumer();
+    }
+    void run() override
+    {
+        pathProducer.process(getConfig());
+        const juce::ScopedLock lock(clientLock);
+        if (client != nullptr)
+        {
+            client->analyzerJobFinished();
+        }
+    }
+    void discard() override
+    {
+        pathProducer.discard();
+    }
+    PathProducer& getPathProducer()
+    {
+        return pathProducer;
+    }
+private:
+    PathProducer pathProducer;
+    std::function<AnalyzerConfig()> getConfig;
+    juce::CriticalSection clientLock;
+    Client* client = nullptr;
+    std::atomic<bool> attached {false};
+    std::atomic<bool> visible {false};
+    juce::SharedResourcePointer<AnalyzerScheduler> scheduler;
+};
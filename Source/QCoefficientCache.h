@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <JuceHeader.h>
+#include "QFilterDesign.h"
+struct CacheStatistics
+{
+    juce::uint64 hits = 0;
+    juce::uint64 misses = 0;
+    double getHitRate() const
+    {
+        const auto lookups = hits + misses;
+        return lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+};
+struct CacheCounters
+{
+    std::atomic<juce::uint64> hits {0};
+    std::atomic<juce::uint64> misses {0};
+    CacheStatistics getStatistics() const noexcept
+    {
+        return {hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed)};
+    }
+    void reset() noexcept
+    {
+        hits.store(0, std::memory_order_relaxed);
+        misses.store(0, std::memory_order_relaxed);
+    }
+};
+class CoefficientCache
+{
+public:
+    static constexpr float FREQ_STEP = 0.1f;
+    static constexpr float QUAL_STEP = 0.001f;
+    static constexpr float GAIN_STEP = 0.01f;
+    static constexpr int CAPACITY = 4096;
+    static constexpr int MAX_PROBES = 8;
+    BiquadCoefficients get(BandTopology topology, int type, double sr, T freq, T q, T gainDecibels, CacheCounters* counters = nullptr) noexcept
+    {
+        const Key key = makeKey(topology, type, sr, freq, q, gainDecibels);
+        const auto home = static_cast<int>(hash(key) & (CAPACITY - 1));
+        BiquadCoefficients coefficients;
+        for (int probe = 0; probe < MAX_PROBES; ++probe)
+        {
+            if (tryRead(slots[static_cast<size_t>((home + probe) & (CAPACITY - 1))], key, coefficients))
+            {
+                if (counters != nullptr)
+                {
+                    counters->hits.fetch_add(1, std::memory_order_relaxed);
+                }
+                return coefficients;
+            }
+        }
+        if (counters != nullptr)
+        {
+            counters->misses.fetch_add(1, std::memory_order_relaxed);
+        }
+        coefficients = designBand(topology, type, sr, freq, q, juce::Decibels::decibelsToGain(gainDecibels));
+        insert(home, key, coefficients);
+        return coefficients;
+    }
+    FilterCascade getCascade(BandTopology topology, int type, int slope, double sr, T freq, T q, T gainDecibels, CacheCounters* counters = nullptr) noexcept
+    {
+        if (slope <= 0 || slope >= static_cast<int>(std::size(slopeShapes)) || !hasSlope(type))
+        {
+            return FilterCascade::single(get(topology, type, sr, freq, q, gainDecibels, counters));
+        }
+        const auto& shape = slopeShapes[slope];
+        FilterCascade cascade;
+        cascade.sections = shape.sections;
+        for (int section = 0; section < shape.sections; ++section)
+        {
+            cascade.stages[static_cast<size_t>(section)] = get(topology, type, sr, freq, getSectionQuality(shape, section), gainDecibels, counters);
+        }
+        return cascade;
+    }
+private:
+    static constexpr juce::uint64 OCCUPIED = juce::uint64(1) << 63;
+    struct Key
+    {
+        juce::uint64 shape = 0;
+        juce::uint64 context = 0;
+    };
+    struct Slot
+    {
+        std::atomic<juce::uint32> sequence {0};
+        std::atomic<juce::uint64> shape {0};
+        std::atomic<juce::uint64> context {0};
+        std::array<std::atomic<float>, 5> values {};
+    };
+    std::array<Slot, CAPACITY> slots;
+    static juce::uint32 quantise(T value, T step) noexcept
+    {
+        return static_cast<juce::uint32>(juce::roundToInt(value / step));
+    }
+    static Key makeKey(BandTopology topology, int type, double sr, T freq, T q, T gainDecibels) noexcept
+    {
+        Key key;
+        key.shape = (juce::uint64(quantise(freq, FREQ_STEP)) << 32) | quantise(q, QUAL_STEP);
+        key.context = OCCUPIED
+            | (juce::uint64(static_cast<juce::uint32>(juce::roundToInt(sr))) << 24)
+            | (juce::uint64(quantise(gainDecibels, GAIN_STEP) & 0xffff) << 8)
+            | (juce::uint64(static_cast<juce::uint32>(type) & 0x7f) << 1)
+            | (topology == BandTopology::Svf ? 1u : 0u);
+        return key;
+    }
+    static juce::uint64 hash(const Key& key) noexcept
+    {
+        juce::uint64 h = key.shape * 0x9e3779b97f4a7c15ull;
+        h ^= (key.context + (h << 6) + (h >> 2)) * 0xc2b2ae3d27d4eb4full;
+        return h ^ (h >> 29);
+    }
+    static bool tryRead(const Slot& slot, const Key& key, BiquadCoefficients& coefficients) noexcept
+    {
+        const auto before = slot.sequence.load(std::memory_order_acquire);
+        if ((before & 1u) != 0)
+        {
+            return false;
+        }
+        if (slot.shape.load(std::memory_order_relaxed) != key.shape || slot.context.load(std::memory_order_relaxed) != key.context)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < coefficients.size(); ++i)
+        {
+            coefficients[i] = slot.values[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == before;
+    }
+    void insert(int home, const Key& key, const BiquadCoefficients& coefficients) noexcept
+    {
+        int target = home;
+        for (int probe = 0; probe < MAX_PROBES; ++probe)
+        {
+            const int index = (home + probe) & (CAPACITY - 1);
+            if ((slots[static_cast<size_t>(index)].context.load(std::memory_order_relaxed) & OCCUPIED) == 0)
+            {
+                target = index;
+                break;
+            }
+        }
+        auto& slot = slots[static_cast<size_t>(target)];
+        auto sequence = slot.sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1u) != 0 || !slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.shape.store(key.shape, std::memory_order_relaxed);
+        slot.context.store(key.context, std::memory_order_relaxed);
+        for (size_t i = 0; i < coefficients.size(); ++i)
+        {
+            slot.values[i].store(coefficients[i], std::memory_order_relaxed);
+        }
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+    }
+};
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <JuceHeader.h>
+#include "QFilterBank.h"
+#include "QFilterDesign.h"
+struct DynamicBandSettings
+{
+    bool enabled = false;
+    int type = static_cast<int>(FilterType::Peak);
+    BandTopology topology = BandTopology::Biquad;
+    BandRouting routing = BandRouting::Stereo;
+    float freq = 1000.0f;
+    float q = 1.0f;
+    float gain = 0.0f;
+    float threshold = 0.0f;
+    float ratio = 1.0f;
+    float attack = 10.0f;
+    float release = 100.0f;
+};
+template <int NumBands>
+class DynamicEq
+{
+public:
+    using SIMD = juce::dsp::SIMDRegister<float>;
+    static constexpr int LANES = static_cast<int>(SIMD::SIMDNumElements);
+    static constexpr int NUM_GROUPS = (NumBands + LANES - 1) / LANES;
+    static constexpr int UPDATE_INTERVAL = 32;
+    static constexpr float MIN_GAIN_CHANGE = 0.01f;
+    static constexpr float MAX_REDUCTION = 24.0f;
+    DynamicEq()
+    {
+        for (auto& reduction : reductions)
+        {
+            reduction.store(0.0f, std::memory_order_relaxed);
+        }
+        clearLanes();
+        reset();
+    }
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+    void reset()
+    {
+        for (int group = 0; group < NUM_GROUPS; ++group)
+        {
+            state1[group] = SIMD::expand(0.0f);
+            state2[group] = SIMD::expand(0.0f);
+            envelopes[group] = SIMD::expand(0.0f);
+        }
+        appliedGains.fill(std::numeric_limits<float>::infinity());
+    }
+    void configure(int band, const DynamicBandSettings& settings)
+    {
+        const int group = band / LANES;
+        const auto lane = static_cast<size_t>(band % LANES);
+        const auto type = static_cast<FilterType>(settings.type);
+        const bool dynamic = settings.enabled && (type == FilterType::Peak || type == FilterType::LowShelf || type == FilterType::HighShelf);
+        const uint32_t bit = 1u << band;
+        if (!dynamic)
+        {
+            for (auto* lanes : {&b0, &b1, &b2, &a1, &a2, &weightsLeft, &weightsRight, &state1, &state2, &envelopes})
+            {
+                (*lanes)[group].set(lane, 0.0f);
+            }
+            activeMask &= ~bit;
+            reductions[static_cast<size_t>(band)].store(0.0f, std::memory_order_relaxed);
+            return;
+        }
+        if ((activeMask & bit) == 0)
+        {
+            state1[group].set(lane, 0.0f);
+            state2[group].set(lane, 0.0f);
+            envelopes[group].set(lane, 0.0f);
+        }
+        const auto freq = juce::jmin(settings.freq, static_cast<float>(sampleRate * 0.49));
+        const auto detector = designDetector(type, freq, settings.q);
+        b0[group].set(lane, detector[0]);
+        b1[group].set(lane, detector[1]);
+        b2[group].set(lane, detector[2]);
+        a1[group].set(lane, detector[3]);
+        a2[group].set(lane, detector[4]);
+        const auto weights = getWeights(settings.routing);
+        weightsLeft[group].set(lane, weights.first);
+        weightsRight[group].set(lane, weights.second);
+        attacks[group].set(lane, getSmoothing(settings.attack));
+        releases[group].set(lane, getSmoothing(settings.release));
+        designers[static_cast<size_t>(band)].prepare(settings.topology, settings.type, sampleRate, freq, settings.q);
+        thresholds[static_cast<size_t>(band)] = settings.threshold;
+        slopes[static_cast<size_t>(band)] = 1.0f - 1.0f / juce::jmax(1.0f, settings.ratio);
+        staticGains[static_cast<size_t>(band)] = settings.gain;
+        appliedGains[static_cast<size_t>(band)] = std::numeric_limits<float>::infinity();
+        activeMask |= bit;
+    }
+    bool isActive() const
+    {
+        return activeMask != 0;
+    }
+    bool isDynamic(int band) const
+    {
+        return (activeMask & (1u << band)) != 0;
+    }
+    void process(const float* left, const float* right, int numSamples)
+    {
+        const auto zero = SIMD::expand(0.0f);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto l = SIMD::expand(left[i]);
+            const auto r = SIMD::expand(right[i]);
+            for (int group = 0; group < NUM_GROUPS; ++group)
+            {
+                const auto x = weightsLeft[group] * l + weightsRight[group] * r;
+                const auto y = b0[group] * x + state1[group];
+                state1[group] = b1[group] * x - a1[group] * y + state2[group];
+                state2[group] = b2[group] * x - a2[group] * y;
+                const auto difference = SIMD::max(y, zero - y) - envelopes[group];
+                envelopes[group] = envelopes[group] + attacks[group] * SIMD::max(difference, zero) + releases[group] * SIMD::min(difference, zero);
+            }
+        }
+    }
+    template <typename Apply>
+    void update(Apply&& apply)
+    {
+        for (int band = 0; band < NumBands; ++band)
+        {
+            if (!isDynamic(band))
+            {
+                continue;
+            }
+            const auto index = static_cast<size_t>(band);
+            const float level = juce::Decibels::gainToDecibels(envelopes[band / LANES].get(static_cast<size_t>(band % LANES)));
+            const float reduction = juce::jmin(MAX_REDUCTION, juce::jmax(0.0f, level - thresholds[index]) * slopes[index]);
+            const float gain = staticGains[index] - reduction;
+            if (std::abs(gain - appliedGains[index]) < MIN_GAIN_CHANGE)
+            {
+                continue;
+            }
+            appliedGains[index] = gain;
+            reductions[index].store(reduction, std::memory_order_relaxed);
+            apply(band, designers[index].design(gain));
+        }
+    }
+    float getGainReduction(int band) const
+    {
+        return reductions[static_cast<size_t>(band)].load(std::memory_order_relaxed);
+    }
+private:
+    using Lanes = std::array<SIMD, NUM_GROUPS>;
+    Lanes b0, b1, b2, a1, a2;
+    Lanes weightsLeft, weightsRight;
+    Lanes attacks, releases;
+    Lanes state1, state2, envelopes;
+    std::array<GainDesigner, NumBands> designers;
+    std::array<float, NumBands> thresholds {};
+    std::array<float, NumBands> slopes {};
+    std::array<float, NumBands> staticGains {};
+    std::array<float, NumBands> appliedGains {};
+    std::array<std::atomic<float>, NumBands> reductions;
+    uint32_t activeMask = 0;
+    double sampleRate = 44100.0;
+    void clearLanes()
+    {
+        for (auto* lanes : {&b0, &b1, &b2, &a1, &a2, &weightsLeft, &weightsRight, &attacks, &releases})
+        {
+            lanes->fill(SIMD::expand(0.0f));
+        }
+    }
+    BiquadCoefficients designDetector(FilterType type, float f, float q) const
+    {
+        std::array<float, 6> c;
+        switch (type)
+        {
+            case FilterType::LowShelf:
+                c = juce::dsp::IIR::ArrayCoefficients<float>::makeLowPass(sampleRate, f);
+                break;
+            case FilterType::HighShelf:
+                c = juce::dsp::IIR::ArrayCoefficients<float>::makeHighPass(sampleRate, f);
+                break;
+            case FilterType::Peak:
+            default:
+                c = juce::dsp::IIR::ArrayCoefficients<float>::makeBandPass(sampleRate, f, q);
+                break;
+        }
+        const float a0inv = 1.0f / c[3];
+        return {c[0] * a0inv, c[1] * a0inv, c[2] * a0inv, c[4] * a0inv, c[5] * a0inv};
+    }
+    static std::pair<float, float> getWeights(BandRouting routing)
+    {
+        switch (routing)
+        {
+            case BandRouting::Left: return {1.0f, 0.0f};
+            case BandRouting::Right: return {0.0f, 1.0f};
+            case BandRouting::Side: return {0.5f, -0.5f};
+            case BandRouting::Stereo:
+            case BandRouting::Mid:
+            default: return {0.5f, 0.5f};
+        }
+    }
+    float getSmoothing(float milliseconds) const
+    {
+        const double samples = juce::jmax(1.0, static_cast<double>(milliseconds) * 0.001 * sampleRate);
+        return static_cast<float>(1.0 - std::exp(-1.0 / samples));
+    }
+};
@@ -32,87 +32,93 @@ struct Fifo
 private:
     std::array<T, 32> buffers;
     juce::AbstractFifo fifo{32};
-    std::mutex mutex;
 };
-template <int Capacity>
-struct AudioBufferFifo
+struct SingleChannelSampleFifo
 {
-    void prepare(const int numChannels, const int numSamples)
+    void update(const juce::AudioBuffer<float>& buffer, uint32_t channelMask)
     {
-        for (auto& buffer : buffers)
+        std::array<const float*, MAX_SOURCE_CHANNELS> sources;
+        int numSources = 0;
+        for (int ch = 0; ch < juce::jmin(buffer.getNumChannels(), MAX_SOURCE_CHANNELS); ++ch)
         {
-            buffer.setSize(numChannels, numSamples, false, true, true);
-            buffer.clear();
+            if (channelMask & (1u << ch))
+            {
+                sources[numSources++] = buffer.getReadPointer(ch);
+            }
         }
-    }
-    bool push(const juce::AudioBuffer<float>& t)
-    {
-        auto write = fifo.write(1);
-        if (write.blockSize1 > 0)
+        if (numSources == 0)
         {
-            buffers[write.startIndex1] = t;
-            return true;
+            return;
         }
-        return false;
-    }
-    bool pull(juce::AudioBuffer<float>& t)
-    {
-        auto read = fifo.read(1);
-        if (read.blockSize1 > 0)
+        const float scale = 1.0f / static_cast<float>(numSources);
+        const int numSamples = buffer.getNumSamples();
+        for (int i = 0; i < numSamples;)
         {
-            t = buffers[read.startIndex1];
-            return true;
-        }
-        return false;
-    }
-    int getNumAvailableForReading() const
-    {
-        return fifo.getNumReady();
-    }
-private:
-    std::array<juce::AudioBuffer<float>, Capacity> buffers;
-    juce::AbstractFifo fifo{Capacity};
-};
-enum Channel
-{
-    Left, Right
-};
-struct SingleChannelSampleFifo
-{
-    SingleChannelSampleFifo(Channel ch): channelToUse(ch)
-    {
-    }
-    void update(const juce::AudioBuffer<float>& buffer)
-    {
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
-        {
-            if (fifoIndex == bufferToFill.getNumSamples())
+            if (fifoIndex == 0)
+            {
+                int start1, size1, start2, size2;
+                hops.prepareToWrite(1, start1, size1, start2, size2);
+                writeHop = size1 > 0 ? start1 : -1;
+            }
+            const int chunk = juce::jmin(HOP_SIZE - fifoIndex, numSamples - i);
+            if (writeHop >= 0)
+            {
+                auto* destination = ring.data() + writeHop * HOP_SIZE + fifoIndex;
+                juce::FloatVectorOperations::copy(destination, sources[0] + i, chunk);
+                for (int source = 1; source < numSources; ++source)
+                {
+                    juce::FloatVectorOperations::add(destination, sources[source] + i, chunk);
+                }
+                if (numSources > 1)
+                {
+                    juce::FloatVectorOperations::multiply(destination, scale, chunk);
+                }
+            }
+            fifoIndex += chunk;
+            i += chunk;
+            if (fifoIndex == HOP_SIZE)
             {
-                juce::ignoreUnused(audioBufferFifo.push(bufferToFill));
+                if (writeHop >= 0)
+                {
+                    hops.finishedWrite(1);
+                }
                 fifoIndex = 0;
             }
-            bufferToFill.setSample(0, fifoIndex, channelPtr[i]);
-            ++fifoIndex;
         }
     }
-    void prepare(int bufferSize)
+    void reset()
     {
-        bufferToFill.setSize(1, bufferSize, false, true, true);
-        audioBufferFifo.prepare(1, bufferSize);
         fifoIndex = 0;
     }
     int getNumCompleteBuffersAvailable() const
     {
-        return audioBufferFifo.getNumAvailableForReading();
+        return hops.getNumReady();
     }
     bool getAudioBuffer(juce::AudioBuffer<float>& buf)
     {
-        return audioBufferFifo.pull(buf);
+        int start1, size1, start2, size2;
+        hops.prepareToRead(1, start1, size1, start2, size2);
+        if (size1 <= 0)
+        {
+            return false;
+        }
+        buf.setSize(1, HOP_SIZE, false, false, true);
+        juce::FloatVectorOperations::copy(buf.getWritePointer(0), ring.data() + start1 * HOP_SIZE, HOP_SIZE);
+        hops.finishedRead(1);
+        return true;
+    }
+    int discard()
+    {
+        const int numReady = hops.getNumReady();
+        hops.finishedRead(numReady);
+        return numReady;
     }
+    static constexpr int HOP_SIZE = 512;
+    static constexpr int NUM_HOPS = 16;
+    static constexpr int MAX_SOURCE_CHANNELS = 32;
 private:
-    Channel channelToUse;
     int fifoIndex = 0;
-    AudioBufferFifo<16> audioBufferFifo;
-    juce::AudioBuffer<float> bufferToFill;
+    int writeHop = -1;
+    juce::AbstractFifo hops {NUM_HOPS};
+    std::array<float, NUM_HOPS * HOP_SIZE> ring {};
 };
@@ -0,0 +1,845 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <vector>
+#include <JuceHeader.h>
+#include "QSimdKernels.h"
+enum class BandRouting: juce::uint8
+{
+    Stereo, Left, Right, Mid, Side
+};
+enum class BandTopology: juce::uint8
+{
+    Biquad, Svf
+};
+static constexpr int MAX_SECTIONS = 8;
+static_assert(MAX_SECTIONS == MAX_KERNEL_SECTIONS, "every cascade length needs a dispatched kernel");
+struct FilterCascade
+{
+    int sections = 1;
+    std::array<std::array<float, 5>, MAX_SECTIONS> stages {};
+    static FilterCascade single(const std::array<float, 5>& coefficients)
+    {
+        FilterCascade cascade;
+        cascade.stages[0] = coefficients;
+        return cascade;
+    }
+};
+template <int NumBands, int MaxChannels>
+class MultiChannelFilterBank
+{
+public:
+    using SIMD = juce::dsp::SIMDRegister<float>;
+    using Coefficients = std::array<float, 5>;
+    static constexpr int LANES = static_cast<int>(SIMD::SIMDNumElements);
+    static constexpr int MAX_WIDTH = std::max(LANES, MaxChannels <= 4 ? 4 : (MaxChannels <= 8 ? 8 : 16));
+    static constexpr int STATE_LANES = (MaxChannels + MAX_WIDTH - 1) / MAX_WIDTH * MAX_WIDTH;
+    static constexpr int MAX_PRECISE_WIDTH = MaxChannels <= 2 ? 2 : (MaxChannels <= 4 ? 4 : 8);
+    static constexpr int PRECISE_LANES = (MaxChannels + MAX_PRECISE_WIDTH - 1) / MAX_PRECISE_WIDTH * MAX_PRECISE_WIDTH;
+    static constexpr size_t CACHE_LINE = 64;
+    MultiChannelFilterBank()
+    {
+        for (auto& band : bands)
+        {
+            band.coefficients = FilterCascade::single(IDENTITY);
+            band.steps.fill({});
+        }
+        targets.fill(FilterCascade::single(IDENTITY));
+        control.fadeSamples.fill(0);
+        control.bypassAfterFade.fill(false);
+        control.bypassed.fill(true);
+        control.routings.fill(BandRouting::Stereo);
+        control.topologies.fill(BandTopology::Biquad);
+        reset();
+    }
+    void prepare(int channels, int maximumBlockSize)
+    {
+        numChannels = juce::jlimit(0, MaxChannels, channels);
+        blockSize = juce::jmax(1, maximumBlockSize);
+        preciseStates.reserve(static_cast<size_t>(NumBands * MAX_SECTIONS * PRECISE_LANES * 2));
+        preciseFrames.reserve(static_cast<size_t>(PRECISE_LANES * blockSize));
+        configureKernels();
+        reset();
+    }
+    void setDoublePrecision(bool shouldUseDoublePrecision)
+    {
+        if (doublePrecision != shouldUseDoublePrecision)
+        {
+            doublePrecision = shouldUseDoublePrecision;
+            preciseStates.assign(doublePrecision ? static_cast<size_t>(NumBands * MAX_SECTIONS * PRECISE_LANES * 2) : 0, 0.0);
+            configureKernels();
+            reset();
+        }
+    }
+    void setSimdIsa(SimdIsa newIsa)
+    {
+        simdIsa = SimdDispatch::isSupported(newIsa) ? newIsa : SimdIsa::Sse2;
+        configureKernels();
+        reset();
+    }
+    SimdIsa getSimdIsa() const
+    {
+        return simdIsa;
+    }
+    int getGroupWidth() const
+    {
+        return width;
+    }
+    int getPreciseWidth() const
+    {
+        return preciseKernels.isValid() ? preciseWidth : 1;
+    }
+    static constexpr size_t getHotBytes()
+    {
+        return sizeof(BandControl) + sizeof(BandState) * NumBands;
+    }
+    int getActiveCacheLines() const
+    {
+        int lines = getCacheLines(sizeof(BandControl));
+        for (int band = 0; band < NumBands; ++band)
+        {
+            if (!control.bypassed[band])
+            {
+                const int sections = bands[band].coefficients.sections;
+                lines += getCacheLines(sizeof(int) + sizeof(Coefficients) * static_cast<size_t>(sections));
+                lines += sections * getCacheLines(sizeof(float) * static_cast<size_t>(doublePrecision ? 0 : numGroups * width * 2));
+            }
+        }
+        return lines;
+    }
+    static constexpr int getCacheLines(size_t bytes)
+    {
+        return static_cast<int>((bytes + CACHE_LINE - 1) / CACHE_LINE);
+    }
+    size_t getHeapBytes() const
+    {
+        return frames.capacity() * sizeof(SIMD) + preciseFrames.capacity() * sizeof(double) + preciseStates.capacity() * sizeof(double);
+    }
+    bool isDoublePrecision() const
+    {
+        return doublePrecision;
+    }
+    void reset()
+    {
+        for (int band = 0; band < NumBands; ++band)
+        {
+            resetBand(band);
+        }
+    }
+    void setCoefficients(int band, const Coefficients& newCoefficients)
+    {
+        setCoefficients(band, FilterCascade::single(newCoefficients));
+    }
+    void setCoefficients(int band, const FilterCascade& newCoefficients)
+    {
+        resetSections(band, bands[band].coefficients.sections, newCoefficients.sections);
+        bands[band].coefficients = newCoefficients;
+        targets[band] = newCoefficients;
+        control.fadeSamples[band] = 0;
+        if (control.bypassAfterFade[band])
+        {
+            control.bypassAfterFade[band] = false;
+            control.bypassed[band] = true;
+        }
+    }
+    void glideTo(int band, const Coefficients& newCoefficients, int numSamples)
+    {
+        glideTo(band, FilterCascade::single(newCoefficients), numSamples);
+    }
+    void glideTo(int band, const FilterCascade& newCoefficients, int numSamples)
+    {
+        if (control.bypassed[band] || control.bypassAfterFade[band])
+        {
+            setCoefficients(band, newCoefficients);
+            return;
+        }
+        fadeTo(band, newCoefficients, false, numSamples);
+    }
+    void fadeTo(int band, const Coefficients& newCoefficients, bool shouldBeBypassed, int numSamples)
+    {
+        fadeTo(band, FilterCascade::single(newCoefficients), shouldBeBypassed, numSamples);
+    }
+    void fadeTo(int band, const FilterCascade& newCoefficients, bool shouldBeBypassed, int numSamples)
+    {
+        if (numSamples <= 0 || (control.bypassed[band] && shouldBeBypassed))
+        {
+            setCoefficients(band, newCoefficients);
+            setBypassed(band, shouldBeBypassed);
+            return;
+        }
+        auto& current = bands[band].coefficients;
+        if (control.bypassed[band])
+        {
+            resetBand(band);
+            current.sections = 0;
+            control.bypassed[band] = false;
+        }
+        const int sections = juce::jmax(current.sections, newCoefficients.sections);
+        for (int section = current.sections; section < sections; ++section)
+        {
+            current.stages[static_cast<size_t>(section)] = getIdentity(band, newCoefficients.stages[static_cast<size_t>(section)]);
+        }
+        resetSections(band, current.sections, sections);
+        current.sections = sections;
+        for (int section = 0; section < sections; ++section)
+        {
+            const auto& from = current.stages[static_cast<size_t>(section)];
+            const bool fadesOut = shouldBeBypassed || section >= newCoefficients.sections;
+            const auto end = fadesOut ? getIdentity(band, from) : newCoefficients.stages[static_cast<size_t>(section)];
+            for (size_t k = 0; k < 5; ++k)
+            {
+                bands[band].steps[static_cast<size_t>(section)][k] = (end[k] - from[k]) / static_cast<float>(numSamples);
+            }
+        }
+        targets[band] = newCoefficients;
+        control.fadeSamples[band] = numSamples;
+        control.bypassAfterFade[band] = shouldBeBypassed;
+    }
+    void setBypassed(int band, bool shouldBeBypassed)
+    {
+        if (control.bypassAfterFade[band])
+        {
+            control.bypassAfterFade[band] = false;
+            bands[band].coefficients = targets[band];
+            control.fadeSamples[band] = 0;
+        }
+        control.bypassed[band] = shouldBeBypassed;
+    }
+    bool isBypassed(int band) const
+    {
+        return control.bypassed[band] || control.bypassAfterFade[band];
+    }
+    void setTopology(int band, BandTopology newTopology)
+    {
+        if (control.topologies[band] != newTopology)
+        {
+            control.topologies[band] = newTopology;
+            resetBand(band);
+        }
+    }
+    BandTopology getTopology(int band) const
+    {
+        return control.topologies[band];
+    }
+    int getNumSections(int band) const
+    {
+        return targets[band].sections;
+    }
+    float getPoleRadius(int band, int section) const
+    {
+        const auto& c = targets[band].stages[static_cast<size_t>(section)];
+        float a1 = c[3];
+        float a2 = c[4];
+        if (control.topologies[band] == BandTopology::Svf)
+        {
+            const float a0 = 1.0f + c[0] * (c[0] + c[1]);
+            a1 = 2.0f * (c[0] * c[0] - 1.0f) / a0;
+            a2 = (1.0f - c[0] * c[1] + c[0] * c[0]) / a0;
+        }
+        const float discriminant = a1 * a1 - 4.0f * a2;
+        if (discriminant < 0.0f)
+        {
+            return std::sqrt(a2);
+        }
+        const float root = std::sqrt(discriminant);
+        return juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root)) * 0.5f;
+    }
+    void setRouting(int band, BandRouting newRouting)
+    {
+        if (control.routings[band] != newRouting)
+        {
+            control.routings[band] = newRouting;
+            resetBand(band);
+        }
+    }
+    void process(juce::AudioBuffer<float>& buffer)
+    {
+        process(buffer, 0, buffer.getNumSamples());
+    }
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int totalSamples)
+    {
+        const int channels = juce::jmin(numChannels, buffer.getNumChannels());
+        const bool routed = channels == 2 && needsRoutedProcessing();
+        const int endSample = startSample + totalSamples;
+        for (int start = startSample; start < endSample;)
+        {
+            const int chunk = isFading() ? juce::jmin(blockSize, FADE_INTERVAL) : blockSize;
+            const int numSamples = juce::jmin(chunk, endSample - start);
+            if (doublePrecision)
+            {
+                processPrecise(buffer, start, numSamples, channels);
+            }
+            else if (routed)
+            {
+                processRouted(buffer, start, numSamples);
+            }
+            else
+            {
+                processGroups(buffer, start, numSamples, channels);
+            }
+            advanceFades(numSamples);
+            start += numSamples;
+        }
+    }
+private:
+    static constexpr Coefficients IDENTITY {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    static constexpr int FADE_INTERVAL = 32;
+    struct alignas(CACHE_LINE) BandControl
+    {
+        std::array<int, NumBands> fadeSamples;
+        std::array<bool, NumBands> bypassed;
+        std::array<bool, NumBands> bypassAfterFade;
+        std::array<BandRouting, NumBands> routings;
+        std::array<BandTopology, NumBands> topologies;
+    };
+    static constexpr int STATE_QUADS = 2 * STATE_LANES / LANES;
+    static constexpr int SECTION_STRIDE = STATE_QUADS * LANES;
+    using SectionState = std::array<SIMD, STATE_QUADS>;
+    struct alignas(CACHE_LINE) BandState
+    {
+        std::array<SectionState, MAX_SECTIONS> states;
+        FilterCascade coefficients;
+        std::array<Coefficients, MAX_SECTIONS> steps;
+    };
+    BandControl control;
+    std::array<BandState, NumBands> bands;
+    std::array<FilterCascade, NumBands> targets;
+    std::vector<SIMD> frames;
+    std::vector<double> preciseFrames;
+    std::vector<double> preciseStates;
+    CascadeKernels<float> kernels;
+    CascadeKernels<double> preciseKernels;
+    SimdIsa simdIsa = SimdIsa::Sse2;
+    bool doublePrecision = false;
+    int numChannels = 0;
+    int numGroups = 0;
+    int width = LANES;
+    int preciseWidth = 1;
+    int blockSize = 1;
+    void configureKernels()
+    {
+        const int maxWidth = juce::jmin(MAX_WIDTH, SimdDispatch::getMaxWidth(simdIsa));
+        width = LANES;
+        while (width < numChannels && width < maxWidth)
+        {
+            width *= 2;
+        }
+        kernels = SimdDispatch::getCascadeKernels(simdIsa, width);
+        if (!kernels.isValid())
+        {
+            width = LANES;
+        }
+        numGroups = (numChannels + width - 1) / width;
+        frames.assign(static_cast<size_t>(blockSize * width / LANES), SIMD::expand(0.0f));
+        preciseWidth = 2;
+        while (preciseWidth < numChannels && preciseWidth < MAX_PRECISE_WIDTH)
+        {
+            preciseWidth *= 2;
+        }
+        preciseKernels = doublePrecision && preciseWidth >= numChannels ? SimdDispatch::getPreciseCascadeKernels(simdIsa, preciseWidth) : CascadeKernels<double> {};
+        if (!preciseKernels.isValid())
+        {
+            preciseWidth = juce::jmax(1, numChannels);
+        }
+        preciseFrames.assign(doublePrecision ? static_cast<size_t>(PRECISE_LANES * blockSize) : 0, 0.0);
+    }
+    Coefficients getIdentity(int band, const Coefficients& reference) const
+    {
+        if (control.topologies[band] == BandTopology::Svf)
+        {
+            return {reference[0], reference[1], 1.0f, 0.0f, 0.0f};
+        }
+        return IDENTITY;
+    }
+    SvfFrame getSvfFrame(int band, int section, int sample) const
+    {
+        const auto& c = bands[band].coefficients.stages[static_cast<size_t>(section)];
+        const auto& d = bands[band].steps[static_cast<size_t>(section)];
+        const float t = static_cast<float>(juce::jmin(sample + 1, control.fadeSamples[band]));
+        const float g = c[0] + d[0] * t;
+        const float k = c[1] + d[1] * t;
+        const float a1 = 1.0f / (1.0f + g * (g + k));
+        const float a2 = g * a1;
+        return {a1, a2, g * a2, c[2] + d[2] * t, c[3] + d[3] * t, c[4] + d[4] * t};
+    }
+    double* getPreciseState(int band, int section)
+    {
+        return preciseStates.data() + (band * MAX_SECTIONS + section) * PRECISE_LANES * 2;
+    }
+    float* getGroupState(int band, int group)
+    {
+        return reinterpret_cast<float*>(bands[band].states[0].data() + group * 2 * (width / LANES));
+    }
+    void resetBand(int band)
+    {
+        resetSections(band, 0, MAX_SECTIONS);
+    }
+    void resetSections(int band, int firstSection, int endSection)
+    {
+        for (int section = firstSection; section < endSection; ++section)
+        {
+            bands[band].states[section].fill(SIMD::expand(0.0f));
+            if (doublePrecision)
+            {
+                std::fill_n(getPreciseState(band, section), PRECISE_LANES * 2, 0.0);
+            }
+        }
+    }
+    template <typename Function>
+    static void dispatchSections(int sections, Function&& function)
+    {
+        switch (sections)
+        {
+            case 1: function(std::integral_constant<int, 1>()); break;
+            case 2: function(std::integral_constant<int, 2>()); break;
+            case 3: function(std::integral_constant<int, 3>()); break;
+            case 4: function(std::integral_constant<int, 4>()); break;
+            case 5: function(std::integral_constant<int, 5>()); break;
+            case 6: function(std::integral_constant<int, 6>()); break;
+            case 7: function(std::integral_constant<int, 7>()); break;
+            case 8: function(std::integral_constant<int, 8>()); break;
+            default: break;
+        }
+    }
+    bool isFading() const
+    {
+        for (int band = 0; band < NumBands; ++band)
+        {
+            if (control.fadeSamples[band] > 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    void advanceFades(int numSamples)
+    {
+        for (int band = 0; band < NumBands; ++band)
+        {
+            if (control.fadeSamples[band] <= 0)
+            {
+                continue;
+            }
+            if (numSamples >= control.fadeSamples[band])
+            {
+                bands[band].coefficients = targets[band];
+                control.fadeSamples[band] = 0;
+                if (control.bypassAfterFade[band])
+                {
+                    control.bypassAfterFade[band] = false;
+                    control.bypassed[band] = true;
+                }
+                continue;
+            }
+            for (int section = 0; section < bands[band].coefficients.sections; ++section)
+            {
+                for (size_t k = 0; k < 5; ++k)
+                {
+                    bands[band].coefficients.stages[static_cast<size_t>(section)][k] += bands[band].steps[static_cast<size_t>(section)][k] * static_cast<float>(numSamples);
+                }
+            }
+            control.fadeSamples[band] -= numSamples;
+        }
+    }
+    void processGroups(juce::AudioBuffer<float>& buffer, int start, int numSamples, int channels)
+    {
+        for (int group = 0; group < numGroups; ++group)
+        {
+            const int firstChannel = group * width;
+            const int groupChannels = juce::jmin(width, channels - firstChannel);
+            if (groupChannels <= 0)
+            {
+                break;
+            }
+            interleave(buffer, start, numSamples, firstChannel, groupChannels);
+            for (int band = 0; band < NumBands; ++band)
+            {
+                if (!control.bypassed[band])
+                {
+                    processBand(band, group, numSamples);
+                }
+            }
+            deinterleave(buffer, start, numSamples, firstChannel, groupChannels);
+        }
+    }
+    bool needsRoutedProcessing() const
+    {
+        for (int band = 0; band < NumBands; ++band)
+        {
+            if (!control.bypassed[band] && control.routings[band] != BandRouting::Stereo)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    void processRouted(juce::AudioBuffer<float>& buffer, int start, int numSamples)
+    {
+        auto* first = buffer.getWritePointer(0, start);
+        auto* second = buffer.getWritePointer(1, start);
+        bool midSide = false;
+        for (int band = 0; band < NumBands; ++band)
+        {
+            if (control.bypassed[band])
+            {
+                continue;
+            }
+            const auto routing = control.routings[band];
+            const bool needsMidSide = routing == BandRouting::Mid || routing == BandRouting::Side;
+            if (needsMidSide != midSide)
+            {
+                convertMidSide(first, second, numSamples, needsMidSide, 1);
+                midSide = needsMidSide;
+            }
+            if (routing != BandRouting::Right && routing != BandRouting::Side)
+            {
+                processChannel(band, 0, first, numSamples);
+            }
+            if (routing != BandRouting::Left && routing != BandRouting::Mid)
+            {
+                processChannel(band, 1, second, numSamples);
+            }
+        }
+        if (midSide)
+        {
+            convertMidSide(first, second, numSamples, false, 1);
+        }
+    }
+    void processPrecise(juce::AudioBuffer<float>& buffer, int start, int numSamples, int channels)
+    {
+        auto* data = preciseFrames.data();
+        for (int ch = 0; ch < preciseWidth; ++ch)
+        {
+            if (ch < channels)
+            {
+                const auto* source = buffer.getReadPointer(ch, start);
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    data[i * preciseWidth + ch] = source[i];
+                }
+            }
+            else
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    data[i * preciseWidth + ch] = 0.0;
+                }
+            }
+        }
+        bool midSide = false;
+        for (int band = 0; band < NumBands; ++band)
+        {
+            if (control.bypassed[band])
+            {
+                continue;
+            }
+            const auto routing = channels == 2 ? control.routings[band] : BandRouting::Stereo;
+            const bool needsMidSide = routing == BandRouting::Mid || routing == BandRouting::Side;
+            if (needsMidSide != midSide)
+            {
+                convertMidSide(data, data + 1, numSamples, needsMidSide, preciseWidth);
+                midSide = needsMidSide;
+            }
+            if (routing == BandRouting::Stereo && preciseKernels.isValid() && canUseKernel(band))
+            {
+                processPreciseBand(band, numSamples);
+                continue;
+            }
+            for (int ch = 0; ch < channels; ++ch)
+            {
+                const bool first = ch == 0 && routing != BandRouting::Right && routing != BandRouting::Side;
+                const bool second = ch == 1 && routing != BandRouting::Left && routing != BandRouting::Mid;
+                if (routing == BandRouting::Stereo || first || second)
+                {
+                    for (int section = 0; section < bands[band].coefficients.sections; ++section)
+                    {
+                        auto* state = getPreciseState(band, section);
+                        processSection(band, section, data + ch, numSamples, state[ch], state[preciseWidth + ch], preciseWidth);
+                    }
+                }
+            }
+        }
+        if (midSide)
+        {
+            convertMidSide(data, data + 1, numSamples, false, preciseWidth);
+        }
+        for (int ch = 0; ch < channels; ++ch)
+        {
+            auto* destination = buffer.getWritePointer(ch, start);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                destination[i] = static_cast<float>(data[i * preciseWidth + ch]);
+            }
+        }
+    }
+    void processPreciseBand(int band, int numSamples)
+    {
+        const int sections = bands[band].coefficients.sections;
+        auto* state = getPreciseState(band, 0);
+        if (control.topologies[band] == BandTopology::Svf)
+        {
+            const auto f = getSvfFrames(band);
+            preciseKernels.svf[static_cast<size_t>(sections - 1)](preciseFrames.data(), numSamples, f.data(), state, PRECISE_LANES * 2);
+        }
+        else
+        {
+            preciseKernels.biquad[static_cast<size_t>(sections - 1)](preciseFrames.data(), numSamples, bands[band].coefficients.stages.data(), state, PRECISE_LANES * 2);
+        }
+    }
+    template <typename Sample>
+    static void convertMidSide(Sample* first, Sample* second, int numSamples, bool encode, int stride)
+    {
+        const Sample scale = encode ? Sample(0.5) : Sample(1);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const Sample a = first[i * stride];
+            const Sample b = second[i * stride];
+            first[i * stride] = (a + b) * scale;
+            second[i * stride] = (a - b) * scale;
+        }
+    }
+    void processChannel(int band, int channel, float* data, int numSamples)
+    {
+        for (int section = 0; section < bands[band].coefficients.sections; ++section)
+        {
+            processChannelSection(band, section, channel, data, numSamples);
+        }
+    }
+    void processChannelSection(int band, int section, int channel, float* data, int numSamples)
+    {
+        const int quads = width / LANES;
+        const int quad = channel / width * 2 * quads + channel % width / LANES;
+        auto& group1 = bands[band].states[section][static_cast<size_t>(quad)];
+        auto& group2 = bands[band].states[section][static_cast<size_t>(quad + quads)];
+        const auto lane = static_cast<size_t>(channel % LANES);
+        float s1 = group1.get(lane);
+        float s2 = group2.get(lane);
+        processSection(band, section, data, numSamples, s1, s2, 1);
+        group1.set(lane, s1);
+        group2.set(lane, s2);
+    }
+    template <typename Sample>
+    void processSection(int band, int section, Sample* data, int numSamples, Sample& s1, Sample& s2, int stride) const
+    {
+        if (control.topologies[band] == BandTopology::Svf)
+        {
+            const bool gliding = control.fadeSamples[band] > 0;
+            auto f = getSvfFrame(band, section, 0);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                if (gliding)
+                {
+                    f = getSvfFrame(band, section, i);
+                }
+                const Sample x = data[i * stride];
+                const Sample v3 = x - s2;
+                const Sample v1 = f.a1 * s1 + f.a2 * v3;
+                const Sample v2 = s2 + f.a2 * s1 + f.a3 * v3;
+                s1 = Sample(2) * v1 - s1;
+                s2 = Sample(2) * v2 - s2;
+                data[i * stride] = f.m0 * x + f.m1 * v1 + f.m2 * v2;
+            }
+        }
+        else
+        {
+            const auto& c = bands[band].coefficients.stages[static_cast<size_t>(section)];
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const Sample x = data[i * stride];
+                const Sample y = c[0] * x + s1;
+                s1 = c[1] * x - c[3] * y + s2;
+                s2 = c[2] * x - c[4] * y;
+                data[i * stride] = y;
+            }
+        }
+    }
+    void interleave(const juce::AudioBuffer<float>& buffer, int start, int numSamples, int firstChannel, int groupChannels)
+    {
+        auto* raw = reinterpret_cast<float*>(frames.data());
+        for (int lane = 0; lane < width; ++lane)
+        {
+            if (lane < groupChannels)
+            {
+                const auto* source = buffer.getReadPointer(firstChannel + lane, start);
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    raw[i * width + lane] = source[i];
+                }
+            }
+            else
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    raw[i * width + lane] = 0.0f;
+                }
+            }
+        }
+    }
+    void deinterleave(juce::AudioBuffer<float>& buffer, int start, int numSamples, int firstChannel, int groupChannels) const
+    {
+        const auto* raw = reinterpret_cast<const float*>(frames.data());
+        for (int lane = 0; lane < groupChannels; ++lane)
+        {
+            auto* destination = buffer.getWritePointer(firstChannel + lane, start);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                destination[i] = raw[i * width + lane];
+            }
+        }
+    }
+    bool canUseKernel(int band) const
+    {
+        return control.topologies[band] != BandTopology::Svf || control.fadeSamples[band] <= 0;
+    }
+    std::array<SvfFrame, MAX_SECTIONS> getSvfFrames(int band) const
+    {
+        std::array<SvfFrame, MAX_SECTIONS> f {};
+        for (int section = 0; section < bands[band].coefficients.sections; ++section)
+        {
+            f[static_cast<size_t>(section)] = getSvfFrame(band, section, 0);
+        }
+        return f;
+    }
+    void processBand(int band, int group, int numSamples)
+    {
+        const int sections = bands[band].coefficients.sections;
+        if (kernels.isValid() && sections > 0 && canUseKernel(band))
+        {
+            auto* raw = reinterpret_cast<float*>(frames.data());
+            if (control.topologies[band] == BandTopology::Svf)
+            {
+                const auto f = getSvfFrames(band);
+                kernels.svf[static_cast<size_t>(sections - 1)](raw, numSamples, f.data(), getGroupState(band, group), SECTION_STRIDE);
+            }
+            else
+            {
+                kernels.biquad[static_cast<size_t>(sections - 1)](raw, numSamples, bands[band].coefficients.stages.data(), getGroupState(band, group), SECTION_STRIDE);
+            }
+            return;
+        }
+        dispatchSections(bands[band].coefficients.sections, [&](auto sections)
+        {
+            if (control.topologies[band] == BandTopology::Svf)
+            {
+                processSvfBand<decltype(sections)::value>(band, group, numSamples);
+            }
+            else
+            {
+                processBiquadBand<decltype(sections)::value>(band, group, numSamples);
+            }
+        });
+    }
+    template <int Sections>
+    void processSvfBand(int band, int group, int numSamples)
+    {
+        if (control.fadeSamples[band] > 0)
+        {
+            processGlidingSvfBand<Sections>(band, group, numSamples);
+            return;
+        }
+        std::array<SIMD, Sections> a1, a2, a3, m0, m1, m2, s1, s2;
+        for (int section = 0; section < Sections; ++section)
+        {
+            const auto f = getSvfFrame(band, section, 0);
+            a1[section] = SIMD::expand(f.a1);
+            a2[section] = SIMD::expand(f.a2);
+            a3[section] = SIMD::expand(f.a3);
+            m0[section] = SIMD::expand(f.m0);
+            m1[section] = SIMD::expand(f.m1);
+            m2[section] = SIMD::expand(f.m2);
+            s1[section] = bands[band].states[section][static_cast<size_t>(2 * group)];
+            s2[section] = bands[band].states[section][static_cast<size_t>(2 * group + 1)];
+        }
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = frames[static_cast<size_t>(i)];
+            for (int section = 0; section < Sections; ++section)
+            {
+                const auto v3 = x - s2[section];
+                const auto v1 = a1[section] * s1[section] + a2[section] * v3;
+                const auto v2 = s2[section] + a2[section] * s1[section] + a3[section] * v3;
+                s1[section] = v1 + v1 - s1[section];
+                s2[section] = v2 + v2 - s2[section];
+                x = m0[section] * x + m1[section] * v1 + m2[section] * v2;
+            }
+            frames[static_cast<size_t>(i)] = x;
+        }
+        for (int section = 0; section < Sections; ++section)
+        {
+            bands[band].states[section][static_cast<size_t>(2 * group)] = s1[section];
+            bands[band].states[section][static_cast<size_t>(2 * group + 1)] = s2[section];
+        }
+    }
+    template <int Sections>
+    void processGlidingSvfBand(int band, int group, int numSamples)
+    {
+        const int quads = width / LANES;
+        const int first = group * 2 * quads;
+        std::array<SvfFrame, Sections> f;
+        std::array<SIMD, Sections> s1;
+        std::array<SIMD, Sections> s2;
+        for (int quad = 0; quad < quads; ++quad)
+        {
+            for (int section = 0; section < Sections; ++section)
+            {
+                s1[section] = bands[band].states[section][static_cast<size_t>(first + quad)];
+                s2[section] = bands[band].states[section][static_cast<size_t>(first + quads + quad)];
+            }
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto x = frames[static_cast<size_t>(i * quads + quad)];
+                for (int section = 0; section < Sections; ++section)
+                {
+                    f[section] = getSvfFrame(band, section, i);
+                    const auto v3 = x - s2[section];
+                    const auto v1 = s1[section] * f[section].a1 + v3 * f[section].a2;
+                    const auto v2 = s2[section] + s1[section] * f[section].a2 + v3 * f[section].a3;
+                    s1[section] = v1 + v1 - s1[section];
+                    s2[section] = v2 + v2 - s2[section];
+                    x = x * f[section].m0 + v1 * f[section].m1 + v2 * f[section].m2;
+                }
+                frames[static_cast<size_t>(i * quads + quad)] = x;
+            }
+            for (int section = 0; section < Sections; ++section)
+            {
+                bands[band].states[section][static_cast<size_t>(first + quad)] = s1[section];
+                bands[band].states[section][static_cast<size_t>(first + quads + quad)] = s2[section];
+            }
+        }
+    }
+    template <int Sections>
+    void processBiquadBand(int band, int group, int numSamples)
+    {
+        std::array<SIMD, Sections> b0, b1, b2, a1, a2, s1, s2;
+        for (int section = 0; section < Sections; ++section)
+        {
+            const auto& c = bands[band].coefficients.stages[static_cast<size_t>(section)];
+            b0[section] = SIMD::expand(c[0]);
+            b1[section] = SIMD::expand(c[1]);
+            b2[section] = SIMD::expand(c[2]);
+            a1[section] = SIMD::expand(c[3]);
+            a2[section] = SIMD::expand(c[4]);
+            s1[section] = bands[band].states[section][static_cast<size_t>(2 * group)];
+            s2[section] = bands[band].states[section][static_cast<size_t>(2 * group + 1)];
+        }
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = frames[static_cast<size_t>(i)];
+            for (int section = 0; section < Sections; ++section)
+            {
+                const auto y = b0[section] * x + s1[section];
+                s1[section] = b1[section] * x - a1[section] * y + s2[section];
+                s2[section] = b2[section] * x - a2[section] * y;
+                x = y;
+            }
+            frames[static_cast<size_t>(i)] = x;
+        }
+        for (int section = 0; section < Sections; ++section)
+        {
+            bands[band].states[section][static_cast<size_t>(2 * group)] = s1[section];
+            bands[band].states[section][static_cast<size_t>(2 * group + 1)] = s2[section];
+        }
+    }
+};
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <array>
+#include <complex>
+#include <vector>
+#include <JuceHeader.h>
+#include "QFilterBank.h"
+using T = float;
+using BiquadCoefficients = std::array<T, 5>;
+enum class FilterType
+{
+    HighPass, HighShelf, LowPass, LowShelf, Peak
+};
+template <std::array<T, 6> (*F)(double, T, T, T)>
+static constexpr std::array<T, 6> wrap(double sr, T f, T q, T g) { return F(sr, f, q, g); }
+template <std::array<T, 6> (*F)(double, T, T)>
+static constexpr std::array<T, 6> wrap(double sr, T f, T q, T) { return F(sr, f, q); }
+static constexpr std::array<T, 6> (*filterFactories[])(double, T, T, T) = {
+    wrap<juce::dsp::IIR::ArrayCoefficients<T>::makeHighPass>,
+    wrap<juce::dsp::IIR::ArrayCoefficients<T>::makeHighShelf>,
+    wrap<juce::dsp::IIR::ArrayCoefficients<T>::makeLowPass>,
+    wrap<juce::dsp::IIR::ArrayCoefficients<T>::makeLowShelf>,
+    wrap<juce::dsp::IIR::ArrayCoefficients<T>::makePeakFilter>
+};
+static inline BiquadCoefficients designFilter(int type, double sr, T f, T q, T g)
+{
+    const auto c = filterFactories[type](sr, f, q, g);
+    const T a0inv = T(1) / c[3];
+    return {c[0] * a0inv, c[1] * a0inv, c[2] * a0inv, c[4] * a0inv, c[5] * a0inv};
+}
+static inline BiquadCoefficients designSvf(int type, double sr, T f, T q, T g)
+{
+    const double A = std::sqrt(static_cast<double>(g));
+    double w = std::tan(juce::MathConstants<double>::pi * f / sr);
+    double k = 1.0 / q;
+    switch (static_cast<FilterType>(type))
+    {
+        case FilterType::HighPass:
+            return {T(w), T(k), T(1), T(-k), T(-1)};
+        case FilterType::LowPass:
+            return {T(w), T(k), T(0), T(0), T(1)};
+        case FilterType::LowShelf:
+            w /= std::sqrt(A);
+            return {T(w), T(k), T(1), T(k * (A - 1.0)), T(A * A - 1.0)};
+        case FilterType::HighShelf:
+            w *= std::sqrt(A);
+            return {T(w), T(k), T(A * A), T(k * (1.0 - A) * A), T(1.0 - A * A)};
+        case FilterType::Peak:
+        default:
+            k = 1.0 / (q * A);
+            return {T(w), T(k), T(1), T(k * (A * A - 1.0)), T(0)};
+    }
+}
+static inline BiquadCoefficients svfToBiquad(const BiquadCoefficients& c)
+{
+    const double g = c[0];
+    const double k = c[1];
+    const double a0 = 1.0 + g * (g + k);
+    const double a1 = 2.0 * (g * g - 1.0);
+    const double a2 = 1.0 - g * k + g * g;
+    const double b0 = c[2] * a0 + c[3] * g + c[4] * g * g;
+    const double b1 = c[2] * a1 + 2.0 * c[4] * g * g;
+    const double b2 = c[2] * a2 - c[3] * g + c[4] * g * g;
+    return {T(b0 / a0), T(b1 / a0), T(b2 / a0), T(a1 / a0), T(a2 / a0)};
+}
+struct SlopeShape
+{
+    int sections;
+    bool linkwitzRiley;
+};
+static constexpr SlopeShape slopeShapes[] = {{1, false}, {2, false}, {2, true}, {3, false}, {4, false}, {4, true}, {6, false}, {8, false}};
+static inline bool hasSlope(int type)
+{
+    return static_cast<FilterType>(type) == FilterType::HighPass || static_cast<FilterType>(type) == FilterType::LowPass;
+}
+static inline T getSectionQuality(const SlopeShape& shape, int section)
+{
+    const int order = shape.linkwitzRiley ? shape.sections : shape.sections * 2;
+    const int pole = shape.linkwitzRiley ? section % (shape.sections / 2) : section;
+    return T(0.5 / std::cos((2 * pole + 1) * juce::MathConstants<double>::pi / (2 * order)));
+}
+static inline BiquadCoefficients designBand(BandTopology topology, int type, double sr, T f, T q, T g)
+{
+    return topology == BandTopology::Svf ? designSvf(type, sr, f, q, g) : designFilter(type, sr, f, q, g);
+}
+static inline BiquadCoefficients toBiquad(BandTopology topology, const BiquadCoefficients& c)
+{
+    return topology == BandTopology::Svf ? svfToBiquad(c) : c;
+}
+static inline double getMagnitudeForFrequency(const BiquadCoefficients& c, double freq, double sr)
+{
+    const auto z = std::polar(1.0, -juce::MathConstants<double>::twoPi * freq / sr);
+    const auto numerator = double(c[0]) + z * (double(c[1]) + z * double(c[2]));
+    const auto denominator = 1.0 + z * (double(c[3]) + z * double(c[4]));
+    return std::abs(numerator / denominator);
+}
+class ResponseModel
+{
+public:
+    using SIMD = juce::dsp::SIMDRegister<float>;
+    static constexpr int LANES = static_cast<int>(SIMD::SIMDNumElements);
+    void prepare(const float* frequencies, int numFrequencies, double sr)
+    {
+        numPoints = numFrequencies;
+        const auto numGroups = static_cast<size_t>((numPoints + LANES - 1) / LANES);
+        phis.assign(numGroups, SIMD::expand(0.0f));
+        numerators.assign(numGroups, SIMD::expand(1.0f));
+        denominators.assign(numGroups, SIMD::expand(1.0f));
+        auto* raw = reinterpret_cast<float*>(phis.data());
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const double s = std::sin(juce::MathConstants<double>::pi * frequencies[i] / sr);
+            raw[i] = static_cast<float>(s * s);
+        }
+    }
+    int getNumPoints() const
+    {
+        return numPoints;
+    }
+    void getDecibels(const BiquadCoefficients& c, float* decibels)
+    {
+        evaluate(c);
+        const auto* n = reinterpret_cast<const float*>(numerators.data());
+        const auto* d = reinterpret_cast<const float*>(denominators.data());
+        for (int i = 0; i < numPoints; ++i)
+        {
+            decibels[i] = 10.0f * std::log10(juce::jmax(n[i], MIN_POWER) / juce::jmax(d[i], MIN_POWER));
+        }
+    }
+    void addDecibels(const BiquadCoefficients& c, float* decibels)
+    {
+        evaluate(c);
+        const auto* n = reinterpret_cast<const float*>(numerators.data());
+        const auto* d = reinterpret_cast<const float*>(denominators.data());
+        for (int i = 0; i < numPoints; ++i)
+        {
+            decibels[i] += 10.0f * std::log10(juce::jmax(n[i], MIN_POWER) / juce::jmax(d[i], MIN_POWER));
+        }
+    }
+private:
+    static constexpr float MIN_POWER = 1.0e-30f;
+    struct Polynomial
+    {
+        SIMD c0, c1, c2;
+    };
+    std::vector<SIMD> phis;
+    std::vector<SIMD> numerators;
+    std::vector<SIMD> denominators;
+    int numPoints = 0;
+    static Polynomial getPolynomial(double x0, double x1, double x2)
+    {
+        const double sum = x0 + x1 + x2;
+        return {SIMD::expand(static_cast<float>(sum * sum)), SIMD::expand(static_cast<float>(-4.0 * (x0 * x1 + 4.0 * x0 * x2 + x1 * x2))), SIMD::expand(static_cast<float>(16.0 * x0 * x2))};
+    }
+    void evaluate(const BiquadCoefficients& c)
+    {
+        const auto b = getPolynomial(c[0], c[1], c[2]);
+        const auto a = getPolynomial(1.0, c[3], c[4]);
+        for (size_t g = 0; g < phis.size(); ++g)
+        {
+            const auto phi = phis[g];
+            numerators[g] = b.c0 + phi * (b.c1 + phi * b.c2);
+            denominators[g] = a.c0 + phi * (a.c1 + phi * a.c2);
+        }
+    }
+};
+class GainDesigner
+{
+public:
+    void prepare(BandTopology newTopology, int newType, double sr, T f, T q)
+    {
+        topology = newTopology;
+        type = static_cast<FilterType>(newType);
+        quality = q;
+        const double w0 = juce::MathConstants<double>::twoPi * f / sr;
+        cosW0 = std::cos(w0);
+        sinW0 = std::sin(w0);
+        tanHalfW0 = std::tan(w0 * 0.5);
+        fixed = designBand(topology, newType, sr, f, q, T(1));
+    }
+    BiquadCoefficients design(T gainDecibels) const
+    {
+        if (type == FilterType::HighPass || type == FilterType::LowPass)
+        {
+            return fixed;
+        }
+        const double A = std::exp(static_cast<double>(gainDecibels) * LN10_OVER_40);
+        return topology == BandTopology::Svf ? designSvf(A) : designBiquad(A);
+    }
+private:
+    static constexpr double LN10_OVER_40 = 0.05756462732485114;
+    BandTopology topology = BandTopology::Biquad;
+    FilterType type = FilterType::Peak;
+    double quality = 1.0;
+    double cosW0 = 1.0;
+    double sinW0 = 0.0;
+    double tanHalfW0 = 0.0;
+    BiquadCoefficients fixed {1, 0, 0, 0, 0};
+    BiquadCoefficients designSvf(double A) const
+    {
+        const double k = 1.0 / quality;
+        switch (type)
+        {
+            case FilterType::LowShelf:
+                return {T(tanHalfW0 / std::sqrt(A)), T(k), T(1), T(k * (A - 1.0)), T(A * A - 1.0)};
+            case FilterType::HighShelf:
+                return {T(tanHalfW0 * std::sqrt(A)), T(k), T(A * A), T(k * (1.0 - A) * A), T(1.0 - A * A)};
+            case FilterType::Peak:
+            default:
+                return {T(tanHalfW0), T(k / A), T(1), T(k / A * (A * A - 1.0)), T(0)};
+        }
+    }
+    BiquadCoefficients designBiquad(double A) const
+    {
+        double b0, b1, b2, a0, a1, a2;
+        if (type == FilterType::Peak)
+        {
+            const double alpha = sinW0 / (2.0 * quality);
+            b0 = 1.0 + alpha * A;
+            b1 = -2.0 * cosW0;
+            b2 = 1.0 - alpha * A;
+            a0 = 1.0 + alpha / A;
+            a1 = b1;
+            a2 = 1.0 - alpha / A;
+        }
+        else
+        {
+            const double beta = sinW0 * std::sqrt(A) / quality;
+            const double sign = type == FilterType::LowShelf ? 1.0 : -1.0;
+            const double plus = A + 1.0;
+            const double minus = (A - 1.0) * sign;
+            b0 = A * (plus - minus * cosW0 + beta);
+            b1 = 2.0 * A * sign * ((A - 1.0) - (A + 1.0) * cosW0 * sign);
+            b2 = A * (plus - minus * cosW0 - beta);
+            a0 = plus + minus * cosW0 + beta;
+            a1 = -2.0 * sign * ((A - 1.0) + (A + 1.0) * cosW0 * sign);
+            a2 = plus + minus * cosW0 - beta;
+        }
+        const double a0inv = 1.0 / a0;
+        return {T(b0 * a0inv), T(b1 * a0inv), T(b2 * a0inv), T(a1 * a0inv), T(a2 * a0inv)};
+    }
+};
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+class OfflineRenderer
+{
+public:
+    static constexpr int BLOCK_SIZE = 4096;
+    static constexpr double CHUNK_SECONDS = 20.0;
+    static constexpr double PREROLL_DECAY_THRESHOLD = 1.0e-9;
+    static constexpr double NULL_THRESHOLD_DB = -140.0;
+    static constexpr int CHUNKS_IN_FLIGHT_PER_WORKER = 2;
+    using Sink = std::function<bool(const juce::AudioBuffer<float>&, int)>;
+    using Progress = std::function<bool(double)>;
+    OfflineRenderer(const juce::MemoryBlock& state, double sampleRate, int numChannels, int numThreads = 0)
+        : stateData(state), sr(sampleRate), channels(numChannels), threads(numThreads > 0 ? numThreads : juce::SystemStats::getNumCpus())
+    {
+        auto probe = createProcessor();
+        preRollSamples = juce::jmax(static_cast<juce::int64>(BLOCK_SIZE), probe->computeTailSamples(sr, PREROLL_DECAY_THRESHOLD));
+        parallelSafe = !probe->hasDynamicBands();
+    }
+    juce::int64 getPreRollSamples() const
+    {
+        return preRollSamples;
+    }
+    bool isParallelSafe() const
+    {
+        return parallelSafe;
+    }
+    int getNumThreads() const
+    {
+        return parallelSafe ? threads : 1;
+    }
+    bool render(juce::AudioFormatReader& reader, const Sink& sink, const Progress& progress = {})
+    {
+        const auto chunkSamples = static_cast<juce::int64>(CHUNK_SECONDS * sr);
+        const auto length = reader.lengthInSamples;
+        const int numChunks = static_cast<int>((length + chunkSamples - 1) / chunkSamples);
+        if (!parallelSafe || threads <= 1 || numChunks <= 1)
+        {
+            return renderSerial(reader, sink, progress);
+        }
+        Job job(reader, length, chunkSamples, numChunks, juce::jmin(threads, numChunks) * CHUNKS_IN_FLIGHT_PER_WORKER);
+        juce::OwnedArray<Worker> workers;
+        for (int i = 0; i < juce::jmin(threads, numChunks); ++i)
+        {
+            workers.add(new Worker(*this, job, createProcessor(), i));
+        }
+        for (auto* worker : workers)
+        {
+            worker->startThread(juce::Thread::Priority::normal);
+        }
+        bool completed = true;
+        while (job.written.load(std::memory_order_acquire) < numChunks)
+        {
+            const int chunk = job.written.load(std::memory_order_relaxed);
+            std::unique_ptr<juce::AudioBuffer<float>> output;
+            {
+                const juce::ScopedLock lock(job.resultLock);
+                output = std::move(job.results[static_cast<size_t>(chunk)]);
+            }
+            if (output == nullptr)
+            {
+                job.chunkReady.wait(WAIT_INTERVAL);
+                continue;
+            }
+            if (!sink(*output, output->getNumSamples()) || (progress && !progress(static_cast<double>(chunk + 1) / numChunks)))
+            {
+                completed = false;
+                break;
+            }
+            job.written.store(chunk + 1, std::memory_order_release);
+            job.spaceAvailable.signal();
+        }
+        job.cancelled.store(true, std::memory_order_release);
+        for (auto* worker : workers)
+        {
+            worker->signalThreadShouldExit();
+        }
+        job.spaceAvailable.signal();
+        for (auto* worker : workers)
+        {
+            worker->stopThread(-1);
+        }
+        return completed;
+    }
+    bool renderSerial(juce::AudioFormatReader& reader, const Sink& sink, const Progress& progress = {})
+    {
+        auto processor = createProcessor();
+        juce::AudioBuffer<float> block(processor->getTotalNumOutputChannels(), BLOCK_SIZE);
+        const auto length = reader.lengthInSamples;
+        for (juce::int64 position = 0; position < length; position += BLOCK_SIZE)
+        {
+            const int numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(BLOCK_SIZE), length - position));
+            reader.read(&block, 0, numSamples, position, true, true);
+            processSamples(*processor, block, numSamples);
+            if (!sink(block, numSamples) || (progress && !progress(static_cast<double>(position + numSamples) / length)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    static double getNullDecibels(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        float peak = 0.0f;
+        const int numChannels = juce::jmin(a.getNumChannels(), b.getNumChannels());
+        const int numSamples = juce::jmin(a.getNumSamples(), b.getNumSamples());
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* x = a.getReadPointer(ch);
+            const auto* y = b.getReadPointer(ch);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                peak = juce::jmax(peak, std::abs(x[i] - y[i]));
+            }
+        }
+        return juce::Decibels::gainToDecibels(static_cast<double>(peak), -400.0);
+    }
+private:
+    static constexpr int WAIT_INTERVAL = 20;
+    struct Job
+    {
+        Job(juce::AudioFormatReader& r, juce::int64 length, juce::int64 chunk, int chunks, int inFlight)
+            : reader(r), lengthInSamples(length), chunkSamples(chunk), numChunks(chunks), maxInFlight(inFlight), results(static_cast<size_t>(chunks))
+        {
+        }
+        juce::AudioFormatReader& reader;
+        const juce::int64 lengthInSamples;
+        const juce::int64 chunkSamples;
+        const int numChunks;
+        const int maxInFlight;
+        juce::CriticalSection readerLock;
+        juce::CriticalSection resultLock;
+        std::vector<std::unique_ptr<juce::AudioBuffer<float>>> results;
+        std::atomic<int> nextChunk {0};
+        std::atomic<int> written {0};
+        std::atomic<bool> cancelled {false};
+        juce::WaitableEvent chunkReady;
+        juce::WaitableEvent spaceAvailable;
+    };
+    class Worker: public juce::Thread
+    {
+    public:
+        Worker(OfflineRenderer& r, Job& j, std::unique_ptr<QuasarEQAudioProcessor> p, int i)
+            : juce::Thread("Offline Render Worker " + juce::String(i + 1)), renderer(r), job(j), processor(std::move(p)), block(processor->getTotalNumOutputChannels(), BLOCK_SIZE)
+        {
+        }
+        void run() override
+        {
+            for (;;)
+            {
+                const int chunk = job.nextChunk.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= job.numChunks)
+                {
+                    return;
+                }
+                while (chunk - job.written.load(std::memory_order_acquire) >= job.maxInFlight)
+                {
+                    if (threadShouldExit() || job.cancelled.load(std::memory_order_acquire))
+                    {
+                        return;
+                    }
+                    job.spaceAvailable.wait(WAIT_INTERVAL);
+                }
+                if (threadShouldExit() || job.cancelled.load(std::memory_order_acquire))
+                {
+                    return;
+                }
+                auto output = renderChunk(chunk);
+                {
+                    const juce::ScopedLock lock(job.resultLock);
+                    job.results[static_cast<size_t>(chunk)] = std::move(output);
+                }
+                job.chunkReady.signal();
+            }
+        }
+    private:
+        OfflineRenderer& renderer;
+        Job& job;
+        std::unique_ptr<QuasarEQAudioProcessor> processor;
+        juce::AudioBuffer<float> block;
+        std::unique_ptr<juce::AudioBuffer<float>> renderChunk(int chunk)
+        {
+            const auto start = chunk * job.chunkSamples;
+            const auto end = juce::jmin(start + job.chunkSamples, job.lengthInSamples);
+            auto output = std::make_unique<juce::AudioBuffer<float>>(block.getNumChannels(), static_cast<int>(end - start));
+            processor->prepareToPlay(renderer.sr, BLOCK_SIZE);
+            for (auto position = juce::jmax(static_cast<juce::int64>(0), start - renderer.preRollSamples); position < end;)
+            {
+                const auto boundary = position < start ? start : end;
+                const int numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(BLOCK_SIZE), boundary - position));
+                {
+                    const juce::ScopedLock lock(job.readerLock);
+                    job.reader.read(&block, 0, numSamples, position, true, true);
+                }
+                processSamples(*processor, block, numSamples);
+                if (position >= start)
+                {
+                    for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                    {
+                        output->copyFrom(ch, static_cast<int>(position - start), block, ch, 0, numSamples);
+                    }
+                }
+                position += numSamples;
+            }
+            return output;
+        }
+    };
+    const juce::MemoryBlock stateData;
+    const double sr;
+    const int channels;
+    const int threads;
+    juce::int64 preRollSamples = 0;
+    bool parallelSafe = false;
+    std::unique_ptr<QuasarEQAudioProcessor> createProcessor() const
+    {
+        auto processor = std::make_unique<QuasarEQAudioProcessor>();
+        processor->setPlayConfigDetails(channels, channels, sr, BLOCK_SIZE);
+        processor->setStateInformation(stateData.getData(), static_cast<int>(stateData.getSize()));
+        processor->setNonRealtime(true);
+        processor->setAnalyzerEnabled(false);
+        processor->prepareToPlay(sr, BLOCK_SIZE);
+        return processor;
+    }
+    static void processSamples(QuasarEQAudioProcessor& processor, juce::AudioBuffer<float>& block, int numSamples)
+    {
+        juce::AudioBuffer<float> view(block.getArrayOfWritePointers(), block.getNumChannels(), numSamples);
+        juce::MidiBuffer midi;
+        processor.processBlock(view, midi);
+    }
+};
@@ -0,0 +1,343 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <JuceHeader.h>
+#include "QCoefficientCache.h"
+#ifndef QUASAR_PROFILING
+#if JUCE_DEBUG
+#define QUASAR_PROFILING 1
+#else
+#define QUASAR_PROFILING 0
+#endif
+#endif
+struct MemoryFootprint
+{
+    size_t instanceBytes = 0;
+    size_t hotBytes = 0;
+    int activeCacheLines = 0;
+    size_t heapBytes = 0;
+};
+#if QUASAR_PROFILING
+#if JUCE_INTEL
+#if JUCE_MSVC
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+enum class ProfileStage
+{
+    UpdateFilters, FilterBank, OutGain, AnalyzerFifo, Block
+};
+static inline const juce::StringArray profileStageNames {"updateFilters", "filterBank", "outGain", "analyzerFifo", "block"};
+class StageProfiler
+{
+public:
+    static constexpr int NUM_STAGES = 5;
+    static constexpr int NUM_BUCKETS = 40;
+    struct StageSummary
+    {
+        juce::uint64 count = 0;
+        double meanMicroseconds = 0.0;
+        double p99Microseconds = 0.0;
+        double maxMicroseconds = 0.0;
+        std::array<juce::uint64, NUM_BUCKETS> buckets {};
+    };
+    StageProfiler()
+    {
+        calibrationCycles = readCycles();
+        calibrationTicks = juce::Time::getHighResolutionTicks();
+    }
+    static inline juce::uint64 readCycles() noexcept
+    {
+#if JUCE_INTEL
+        return static_cast<juce::uint64>(__rdtsc());
+#elif JUCE_ARM && JUCE_64BIT && !JUCE_MSVC
+        juce::uint64 value;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+#else
+        return static_cast<juce::uint64>(juce::Time::getHighResolutionTicks());
+#endif
+    }
+    void record(ProfileStage stage, juce::uint64 cycles) noexcept
+    {
+        auto& s = stages[static_cast<size_t>(stage)];
+        const int bucket = juce::jmin(NUM_BUCKETS - 1, getBitLength(cycles));
+        s.buckets[static_cast<size_t>(bucket)].fetch_add(1, std::memory_order_relaxed);
+        s.count.fetch_add(1, std::memory_order_relaxed);
+        s.total.fetch_add(cycles, std::memory_order_relaxed);
+        if (cycles > s.max.load(std::memory_order_relaxed))
+        {
+            s.max.store(cycles, std::memory_order_relaxed);
+        }
+    }
+    CacheCounters& getCacheCounters() noexcept
+    {
+        return cacheCounters;
+    }
+    void setMemoryFootprint(const MemoryFootprint& footprint) noexcept
+    {
+        instanceBytes.store(footprint.instanceBytes, std::memory_order_relaxed);
+        hotBytes.store(footprint.hotBytes, std::memory_order_relaxed);
+        activeCacheLines.store(footprint.activeCacheLines, std::memory_order_relaxed);
+        heapBytes.store(footprint.heapBytes, std::memory_order_relaxed);
+    }
+    MemoryFootprint getMemoryFootprint() const noexcept
+    {
+        return {instanceBytes.load(std::memory_order_relaxed), hotBytes.load(std::memory_order_relaxed), activeCacheLines.load(std::memory_order_relaxed), heapBytes.load(std::memory_order_relaxed)};
+    }
+    CacheStatistics getCacheStatistics() const noexcept
+    {
+        return cacheCounters.getStatistics();
+    }
+    void clear() noexcept
+    {
+        cacheCounters.reset();
+        for (auto& s : stages)
+        {
+            for (auto& bucket : s.buckets)
+            {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            s.count.store(0, std::memory_order_relaxed);
+            s.total.store(0, std::memory_order_relaxed);
+            s.max.store(0, std::memory_order_relaxed);
+        }
+    }
+    StageSummary summarise(ProfileStage stage) const
+    {
+        const auto& s = stages[static_cast<size_t>(stage)];
+        const double microsecondsPerCycle = getMicrosecondsPerCycle();
+        StageSummary summary;
+        juce::uint64 histogramCount = 0;
+        for (int i = 0; i < NUM_BUCKETS; ++i)
+        {
+            summary.buckets[static_cast<size_t>(i)] = s.buckets[static_cast<size_t>(i)].load(std::memory_order_relaxed);
+            histogramCount += summary.buckets[static_cast<size_t>(i)];
+        }
+        summary.count = s.count.load(std::memory_order_relaxed);
+        if (summary.count > 0)
+        {
+            summary.meanMicroseconds = static_cast<double>(s.total.load(std::memory_order_relaxed)) / static_cast<double>(summary.count) * microsecondsPerCycle;
+        }
+        summary.maxMicroseconds = static_cast<double>(s.max.load(std::memory_order_relaxed)) * microsecondsPerCycle;
+        const juce::uint64 p99Rank = histogramCount - histogramCount / 100;
+        juce::uint64 running = 0;
+        for (int i = 0; i < NUM_BUCKETS && histogramCount > 0; ++i)
+        {
+            running += summary.buckets[static_cast<size_t>(i)];
+            if (running >= p99Rank)
+            {
+                summary.p99Microseconds = static_cast<double>(getBucketUpperBound(i)) * microsecondsPerCycle;
+                break;
+            }
+        }
+        return summary;
+    }
+    double getMicrosecondsPerCycle() const
+    {
+        const juce::uint64 cycles = readCycles() - calibrationCycles;
+        const juce::int64 ticks = juce::Time::getHighResolutionTicks() - calibrationTicks;
+        if (cycles == 0 || ticks <= 0)
+        {
+            return 0.0;
+        }
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6 / static_cast<double>(cycles);
+    }
+    static juce::uint64 getBucketUpperBound(int bucket)
+    {
+        return bucket == 0 ? 0 : (juce::uint64(1) << bucket) - 1;
+    }
+    bool writeCsv(const juce::File& file) const
+    {
+        juce::String text = "stage,count,mean_us,p99_us,max_us";
+        for (int i = 0; i < NUM_BUCKETS; ++i)
+        {
+            text << ",le_" << juce::String(getBucketUpperBound(i));
+        }
+        text << "\n";
+        for (int stage = 0; stage < NUM_STAGES; ++stage)
+        {
+            const auto summary = summarise(static_cast<ProfileStage>(stage));
+            text << profileStageNames[stage] << "," << juce::String(summary.count) << "," << summary.meanMicroseconds << "," << summary.p99Microseconds << "," << summary.maxMicroseconds;
+            for (const auto bucket : summary.buckets)
+            {
+                text << "," << juce::String(bucket);
+            }
+            text << "\n";
+        }
+        const auto cache = getCacheStatistics();
+        text << "\ncoefficient_cache_hits,coefficient_cache_misses,coefficient_cache_hit_rate\n" << juce::String(cache.hits) << "," << juce::String(cache.misses) << "," << cache.getHitRate() << "\n";
+        const auto footprint = getMemoryFootprint();
+        text << "\ninstance_bytes,hot_bytes,active_cache_lines,heap_bytes\n" << juce::String(static_cast<juce::int64>(footprint.instanceBytes)) << "," << juce::String(static_cast<juce::int64>(footprint.hotBytes)) << "," << juce::String(footprint.activeCacheLines) << "," << juce::String(static_cast<juce::int64>(footprint.heapBytes)) << "\n";
+        return file.replaceWithText(text);
+    }
+    bool writeJson(const juce::File& file) const
+    {
+        juce::DynamicObject::Ptr root = new juce::DynamicObject();
+        root->setProperty("microsecondsPerCycle", getMicrosecondsPerCycle());
+        juce::Array<juce::var> upperBounds;
+        for (int i = 0; i < NUM_BUCKETS; ++i)
+        {
+            upperBounds.add(static_cast<juce::int64>(getBucketUpperBound(i)));
+        }
+        root->setProperty("bucketUpperBoundsCycles", upperBounds);
+        juce::DynamicObject::Ptr stageObject = new juce::DynamicObject();
+        for (int stage = 0; stage < NUM_STAGES; ++stage)
+        {
+            const auto summary = summarise(static_cast<ProfileStage>(stage));
+            juce::DynamicObject::Ptr entry = new juce::DynamicObject();
+            entry->setProperty("count", static_cast<juce::int64>(summary.count));
+            entry->setProperty("meanMicroseconds", summary.meanMicroseconds);
+            entry->setProperty("p99Microseconds", summary.p99Microseconds);
+            entry->setProperty("maxMicroseconds", summary.maxMicroseconds);
+            juce::Array<juce::var> buckets;
+            for (const auto bucket : summary.buckets)
+            {
+                buckets.add(static_cast<juce::int64>(bucket));
+            }
+            entry->setProperty("buckets", buckets);
+            stageObject->setProperty(profileStageNames[stage], entry.get());
+        }
+        root->setProperty("stages", stageObject.get());
+        const auto cache = getCacheStatistics();
+        juce::DynamicObject::Ptr cacheObject = new juce::DynamicObject();
+        cacheObject->setProperty("hits", static_cast<juce::int64>(cache.hits));
+        cacheObject->setProperty("misses", static_cast<juce::int64>(cache.misses));
+        cacheObject->setProperty("hitRate", cache.getHitRate());
+        root->setProperty("coefficientCache", cacheObject.get());
+        const auto footprint = getMemoryFootprint();
+        juce::DynamicObject::Ptr footprintObject = new juce::DynamicObject();
+        footprintObject->setProperty("instanceBytes", static_cast<juce::int64>(footprint.instanceBytes));
+        footprintObject->setProperty("hotBytes", static_cast<juce::int64>(footprint.hotBytes));
+        footprintObject->setProperty("activeCacheLines", footprint.activeCacheLines);
+        footprintObject->setProperty("heapBytes", static_cast<juce::int64>(footprint.heapBytes));
+        root->setProperty("memoryFootprint", footprintObject.get());
+        return file.replaceWithText(juce::JSON::toString(juce::var(root.get())));
+    }
+private:
+    struct Stage
+    {
+        std::array<std::atomic<juce::uint64>, NUM_BUCKETS> buckets {};
+        std::atomic<juce::uint64> count {0};
+        std::atomic<juce::uint64> total {0};
+        std::atomic<juce::uint64> max {0};
+    };
+    std::array<Stage, NUM_STAGES> stages;
+    juce::uint64 calibrationCycles = 0;
+    juce::int64 calibrationTicks = 0;
+    CacheCounters cacheCounters;
+    std::atomic<size_t> instanceBytes {0};
+    std::atomic<size_t> hotBytes {0};
+    std::atomic<int> activeCacheLines {0};
+    std::atomic<size_t> heapBytes {0};
+    static int getBitLength(juce::uint64 value) noexcept
+    {
+        const auto high = static_cast<juce::uint32>(value >> 32);
+        const auto low = static_cast<juce::uint32>(value);
+        if (high != 0)
+        {
+            return 33 + juce::findHighestSetBit(high);
+        }
+        return low != 0 ? 1 + juce::findHighestSetBit(low) : 0;
+    }
+};
+class ScopedStageTimer
+{
+public:
+    ScopedStageTimer(StageProfiler& p, ProfileStage s) noexcept: profiler(p), stage(s), start(StageProfiler::readCycles())
+    {
+    }
+    ~ScopedStageTimer() noexcept
+    {
+        profiler.record(stage, StageProfiler::readCycles() - start);
+    }
+private:
+    StageProfiler& profiler;
+    ProfileStage stage;
+    juce::uint64 start;
+};
+class ProfilerOverlay: public juce::Component, private juce::Timer
+{
+public:
+    ProfilerOverlay(StageProfiler& p): profiler(p)
+    {
+        startTimerHz(REFRESH_RATE);
+    }
+    void paint(juce::Graphics& g) override
+    {
+        g.setColour(juce::Colours::black.withAlpha(0.7f));
+        g.fillRect(getLocalBounds());
+        g.setColour(juce::Colours::white);
+        g.setFont(juce::Font(juce::FontOptions(juce::Font::getDefaultMonospacedFontName(), static_cast<float>(LINE_HEIGHT - 2), juce::Font::plain)));
+        auto area = getLocalBounds().reduced(4, 2);
+        const auto header = juce::String("stage (us)").paddedRight(' ', 14) + juce::String("mean").paddedLeft(' ', 7) + juce::String("p99").paddedLeft(' ', 7) + juce::String("max").paddedLeft(' ', 7);
+        g.drawText(header, area.removeFromTop(LINE_HEIGHT), juce::Justification::centredLeft);
+        for (int stage = 0; stage < StageProfiler::NUM_STAGES; ++stage)
+        {
+            const auto summary = profiler.summarise(static_cast<ProfileStage>(stage));
+            const auto line = profileStageNames[stage].paddedRight(' ', 14)
+                + juce::String(summary.meanMicroseconds, 1).paddedLeft(' ', 7)
+                + juce::String(summary.p99Microseconds, 1).paddedLeft(' ', 7)
+                + juce::String(summary.maxMicroseconds, 1).paddedLeft(' ', 7);
+            g.drawText(line, area.removeFromTop(LINE_HEIGHT), juce::Justification::centredLeft);
+        }
+        const auto cache = profiler.getCacheStatistics();
+        const auto cacheLine = juce::String("coef cache").paddedRight(' ', 14)
+            + (juce::String(cache.getHitRate() * 100.0, 1) + "%").paddedLeft(' ', 7)
+            + juce::String(static_cast<juce::int64>(cache.misses)).paddedLeft(' ', 14);
+        g.drawText(cacheLine, area.removeFromTop(LINE_HEIGHT), juce::Justification::centredLeft);
+        const auto footprint = profiler.getMemoryFootprint();
+        const auto footprintLine = juce::String("hot lines").paddedRight(' ', 14)
+            + juce::String(footprint.activeCacheLines).paddedLeft(' ', 7)
+            + (juce::String(static_cast<double>(footprint.instanceBytes + footprint.heapBytes) / 1024.0, 1) + "k").paddedLeft(' ', 14);
+        g.drawText(footprintLine, area.removeFromTop(LINE_HEIGHT), juce::Justification::centredLeft);
+    }
+    void mouseDown(const juce::MouseEvent& event) override
+    {
+        juce::PopupMenu menu;
+        menu.addItem("Save CSV...", [this] { save("*.csv"); });
+        menu.addItem("Save JSON...", [this] { save("*.json"); });
+        menu.addItem("Reset", [this] { profiler.clear(); });
+        menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(this));
+    }
+    static constexpr int LINE_HEIGHT = 14;
+    static constexpr int WIDTH = 240;
+    static constexpr int HEIGHT = (StageProfiler::NUM_STAGES + 3) * LINE_HEIGHT + 4;
+private:
+    static constexpr int REFRESH_RATE = 4;
+    StageProfiler& profiler;
+    std::unique_ptr<juce::FileChooser> chooser;
+    void save(const juce::String& pattern)
+    {
+        const auto extension = pattern.fromLastOccurrenceOf(".", true, false);
+        const auto initial = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("QuasarEQ-profile" + extension);
+        chooser = std::make_unique<juce::FileChooser>("Save profile", initial, pattern);
+        chooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles | juce::FileBrowserComponent::warnAboutOverwriting, [this, extension](const juce::FileChooser& fc)
+        {
+            const auto file = fc.getResult();
+            if (file == juce::File())
+            {
+                return;
+            }
+            if (extension == ".json")
+            {
+                profiler.writeJson(file);
+            }
+            else
+            {
+                profiler.writeCsv(file);
+            }
+        });
+    }
+    void timerCallback() override
+    {
+        repaint();
+    }
+};
+#define QUASAR_PROFILE_STAGE(profiler, stage) const ScopedStageTimer JUCE_JOIN_MACRO(stageTimer, __LINE__) {profiler, ProfileStage::stage}
+#else
+#define QUASAR_PROFILE_STAGE(profiler, stage)
+#endif
@@ -0,0 +1,175 @@
+#include "QRealtimeCheck.h"
+
+#if QUASAR_RT_CHECK
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#if JUCE_LINUX
+#include <dlfcn.h>
+#include <pthread.h>
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void* __libc_memalign(size_t, size_t);
+extern "C" void __libc_free(void*);
+namespace
+{
+    using LockFunction = int (*)(pthread_mutex_t*);
+    LockFunction resolveMutexLock()
+    {
+        static const auto next = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        return next;
+    }
+    [[maybe_unused]] const LockFunction nextMutexLock = resolveMutexLock();
+}
+#endif
+namespace quasar::rt
+{
+    void reportViolation(const char* what) noexcept
+    {
+        reporting = true;
+        const int count = violationCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        std::fprintf(stderr, "[QUASAR_RT_CHECK] violation #%d on audio thread: %s\n", count, what);
+        const auto trace = juce::SystemStats::getStackBacktrace();
+        std::fputs(trace.toRawUTF8(), stderr);
+        std::fflush(stderr);
+        reporting = false;
+#if QUASAR_RT_CHECK_FATAL
+        std::abort();
+#endif
+    }
+}
+namespace
+{
+    void* rawAllocate(std::size_t size) noexcept
+    {
+#if JUCE_LINUX
+        return __libc_malloc(size);
+#else
+        return std::malloc(size);
+#endif
+    }
+    void rawFree(void* p) noexcept
+    {
+#if JUCE_LINUX
+        __libc_free(p);
+#else
+        std::free(p);
+#endif
+    }
+    void* allocate(std::size_t size)
+    {
+        quasar::rt::check("operator new");
+        if (auto* p = rawAllocate(size == 0 ? 1 : size))
+        {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+    void* allocateAligned(std::size_t size, std::align_val_t alignment)
+    {
+        quasar::rt::check("aligned operator new");
+        const auto align = juce::jmax(sizeof(void*), static_cast<std::size_t>(alignment));
+#if JUCE_WINDOWS
+        if (auto* p = _aligned_malloc(size == 0 ? 1 : size, align))
+#elif JUCE_LINUX
+        if (auto* p = __libc_memalign(align, size == 0 ? 1 : size))
+#else
+        void* p = nullptr;
+        if (::posix_memalign(&p, align, size == 0 ? 1 : size) == 0)
+#endif
+        {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+    void release(void* p) noexcept
+    {
+        if (p != nullptr)
+        {
+            quasar::rt::check("operator delete");
+        }
+        rawFree(p);
+    }
+    void releaseAligned(void* p) noexcept
+    {
+        if (p != nullptr)
+        {
+            quasar::rt::check("aligned operator delete");
+        }
+#if JUCE_WINDOWS
+        _aligned_free(p);
+#else
+        rawFree(p);
+#endif
+    }
+}
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { releaseAligned(p); }
+#if JUCE_LINUX
+extern "C"
+{
+    void* malloc(size_t size) noexcept
+    {
+        quasar::rt::check("malloc");
+        return __libc_malloc(size);
+    }
+    void* calloc(size_t count, size_t size) noexcept
+    {
+        quasar::rt::check("calloc");
+        return __libc_calloc(count, size);
+    }
+    void* realloc(void* p, size_t size) noexcept
+    {
+        quasar::rt::check("realloc");
+        return __libc_realloc(p, size);
+    }
+    int posix_memalign(void** result, size_t alignment, size_t size) noexcept
+    {
+        quasar::rt::check("posix_memalign");
+        if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+        {
+            return EINVAL;
+        }
+        if (auto* p = __libc_memalign(alignment, size))
+        {
+            *result = p;
+            return 0;
+        }
+        return ENOMEM;
+    }
+    void free(void* p) noexcept
+    {
+        if (p != nullptr)
+        {
+            quasar::rt::check("free");
+        }
+        __libc_free(p);
+    }
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        quasar::rt::check("pthread_mutex_lock");
+        return resolveMutexLock()(mutex);
+    }
+}
+#endif
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <JuceHeader.h>
+#ifndef QUASAR_RT_CHECK
+#define QUASAR_RT_CHECK 0
+#endif
+#ifndef QUASAR_RT_CHECK_FATAL
+#define QUASAR_RT_CHECK_FATAL 0
+#endif
+#if QUASAR_RT_CHECK
+namespace quasar::rt
+{
+    inline thread_local int audioScopeDepth = 0;
+    inline thread_local bool reporting = false;
+    inline std::atomic<int> violationCount {0};
+    inline bool isInAudioScope() noexcept
+    {
+        return audioScopeDepth > 0 && !reporting;
+    }
+    void reportViolation(const char* what) noexcept;
+    inline void check(const char* what) noexcept
+    {
+        if (isInAudioScope())
+        {
+            reportViolation(what);
+        }
+    }
+    inline int getViolationCount() noexcept
+    {
+        return violationCount.load(std::memory_order_relaxed);
+    }
+    struct ScopedAudioThread
+    {
+        ScopedAudioThread() noexcept
+        {
+            ++audioScopeDepth;
+        }
+        ~ScopedAudioThread() noexcept
+        {
+            --audioScopeDepth;
+        }
+    };
+    struct ScopedPermit
+    {
+        ScopedPermit() noexcept: depth(audioScopeDepth)
+        {
+            audioScopeDepth = 0;
+        }
+        ~ScopedPermit() noexcept
+        {
+            audioScopeDepth = depth;
+        }
+        const int depth;
+    };
+}
+#define QUASAR_RT_AUDIO_SCOPE const quasar::rt::ScopedAudioThread rtAudioScope
+#define QUASAR_RT_PERMIT const quasar::rt::ScopedPermit rtPermit
+#else
+#define QUASAR_RT_AUDIO_SCOPE
+#define QUASAR_RT_PERMIT
+#endif
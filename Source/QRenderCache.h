@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <JuceHeader.h>
+struct RenderCacheKey
+{
+    int width = 0;
+    int height = 0;
+    float scale = 1.0f;
+    bool operator==(const RenderCacheKey& other) const
+    {
+        return width == other.width && height == other.height && scale == other.scale;
+    }
+    bool operator!=(const RenderCacheKey& other) const
+    {
+        return !(*this == other);
+    }
+    bool isEmpty() const
+    {
+        return width <= 0 || height <= 0;
+    }
+};
+template <int Capacity>
+class ScaledImageCache
+{
+public:
+    const juce::Image* find(const RenderCacheKey& key)
+    {
+        for (auto& entry : entries)
+        {
+            if (entry.image.isValid() && entry.key == key)
+            {
+                entry.lastUse = ++useCounter;
+                return &entry.image;
+            }
+        }
+        return nullptr;
+    }
+    const juce::Image* getMostRecent() const
+    {
+        const Entry* newest = nullptr;
+        for (const auto& entry : entries)
+        {
+            if (entry.image.isValid() && (newest == nullptr || entry.lastUse > newest->lastUse))
+            {
+                newest = &entry;
+            }
+        }
+        return newest != nullptr ? &newest->image : nullptr;
+    }
+    const juce::Image& insert(const RenderCacheKey& key, juce::Image image)
+    {
+        Entry* target = &entries[0];
+        for (auto& entry : entries)
+        {
+            if (!entry.image.isValid() || entry.key == key)
+            {
+                target = &entry;
+                break;
+            }
+            if (entry.lastUse < target->lastUse)
+            {
+                target = &entry;
+            }
+        }
+        target->key = key;
+        target->image = std::move(image);
+        target->lastUse = ++useCounter;
+        return target->image;
+    }
+private:
+    struct Entry
+    {
+        RenderCacheKey key;
+        juce::Image image;
+        uint32_t lastUse = 0;
+    };
+    std::array<Entry, Capacity> entries;
+    uint32_t useCounter = 0;
+};
+class TextWidthCache
+{
+public:
+    TextWidthCache(const juce::Font& f): font(f)
+    {
+    }
+    int getStringWidth(const juce::String& text)
+    {
+        if (widths.contains(text))
+        {
+            return widths[text];
+        }
+        const int width = font.getStringWidth(text);
+        widths.set(text, width);
+        return width;
+    }
+    const juce::Font& getFont() const
+    {
+        return font;
+    }
+private:
+    juce::Font font;
+    juce::HashMap<juce::String, int> widths;
+};
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <vector>
+#include <JuceHeader.h>
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define QUASAR_SHARED_EXPORT_AVAILABLE 1
+#else
+#define QUASAR_SHARED_EXPORT_AVAILABLE 0
+#endif
+struct SharedExportLayout
+{
+    static constexpr juce::uint32 MAGIC = 0x58455351;
+    static constexpr juce::uint32 VERSION = 1;
+    static constexpr int NUM_POINTS = 510;
+    static constexpr int NUM_SLOTS = 4;
+    struct Frame
+    {
+        juce::uint64 index = 0;
+        double sampleRate = 0.0;
+        float leftDB = -100.0f;
+        float rightDB = -100.0f;
+        float spectrum[NUM_POINTS];
+        float peakHold[NUM_POINTS];
+    };
+    struct alignas(64) Slot
+    {
+        std::atomic<juce::uint32> sequence;
+        Frame frame;
+    };
+    std::atomic<juce::uint32> magic;
+    juce::uint32 version;
+    juce::int32 numPoints;
+    juce::int32 numSlots;
+    juce::int32 fftSize;
+    juce::int32 ownerPid;
+    alignas(64) std::atomic<juce::uint64> published;
+    juce::int32 binIndices[NUM_POINTS];
+    Slot slots[NUM_SLOTS];
+    static_assert(std::atomic<juce::uint32>::is_always_lock_free && std::atomic<juce::uint64>::is_always_lock_free, "shared-memory atomics must be address-free");
+};
+struct SharedExportDirectory
+{
+    static constexpr const char* NAME = "/quasar-eq.directory";
+    static constexpr const char* INSTANCE_PREFIX = "/quasar-eq.";
+    static constexpr int MAX_INSTANCES = 256;
+    std::atomic<juce::uint64> entries[MAX_INSTANCES];
+    static juce::String getInstanceName(juce::uint64 key)
+    {
+        return INSTANCE_PREFIX + juce::String::toHexString(static_cast<juce::int64>(key));
+    }
+    static int getPid(juce::uint64 key)
+    {
+        return static_cast<int>(key >> 32);
+    }
+};
+class SharedMemoryRegion
+{
+public:
+    SharedMemoryRegion() = default;
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+    ~SharedMemoryRegion()
+    {
+        close();
+    }
+    bool create(const juce::String& newName, size_t size, bool truncate)
+    {
+        return map(newName, size, true, truncate);
+    }
+    bool open(const juce::String& newName, size_t size)
+    {
+        return map(newName, size, false, false);
+    }
+    void close(bool unlink = false)
+    {
+#if QUASAR_SHARED_EXPORT_AVAILABLE
+        if (data != nullptr)
+        {
+            ::munmap(data, numBytes);
+            if (unlink)
+            {
+                ::shm_unlink(name.toRawUTF8());
+            }
+        }
+#else
+        juce::ignoreUnused(unlink);
+#endif
+        data = nullptr;
+        numBytes = 0;
+        name = {};
+    }
+    static void remove(const juce::String& regionName)
+    {
+#if QUASAR_SHARED_EXPORT_AVAILABLE
+        ::shm_unlink(regionName.toRawUTF8());
+#else
+        juce::ignoreUnused(regionName);
+#endif
+    }
+    void* getData() const
+    {
+        return data;
+    }
+    const juce::String& getName() const
+    {
+        return name;
+    }
+private:
+    void* data = nullptr;
+    size_t numBytes = 0;
+    juce::String name;
+    bool map(const juce::String& newName, size_t size, bool writable, bool truncate)
+    {
+        close();
+#if QUASAR_SHARED_EXPORT_AVAILABLE
+        const int flags = writable ? O_CREAT | O_RDWR | (truncate ? O_TRUNC : 0) : O_RDONLY;
+        const int fd = ::shm_open(newName.toRawUTF8(), flags, 0644);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat info {};
+        bool sized = ::fstat(fd, &info) == 0;
+        if (sized && writable && static_cast<size_t>(info.st_size) < size)
+        {
+            sized = ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+        }
+        else if (sized && !writable)
+        {
+            sized = static_cast<size_t>(info.st_size) >= size;
+        }
+        void* memory = sized ? ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (memory == MAP_FAILED)
+        {
+            return false;
+        }
+        data = memory;
+        numBytes = size;
+        name = newName;
+        return true;
+#else
+        juce::ignoreUnused(newName, size, writable, truncate);
+        return false;
+#endif
+    }
+};
+class SharedSpectrumExport
+{
+public:
+    SharedSpectrumExport() = default;
+    SharedSpectrumExport(const SharedSpectrumExport&) = delete;
+    SharedSpectrumExport& operator=(const SharedSpectrumExport&) = delete;
+    ~SharedSpectrumExport()
+    {
+        close();
+    }
+    bool open(const std::vector<int>& binIndices, int fftSize)
+    {
+        close();
+#if !QUASAR_SHARED_EXPORT_AVAILABLE
+        juce::ignoreUnused(binIndices, fftSize);
+        return false;
+#else
+        if (static_cast<int>(binIndices.size()) != SharedExportLayout::NUM_POINTS || !directoryRegion.create(SharedExportDirectory::NAME, sizeof(SharedExportDirectory), false))
+        {
+            return false;
+        }
+        static std::atomic<juce::uint32> serial {0};
+        const auto pid = static_cast<juce::uint32>(getCurrentPid());
+        key = (static_cast<juce::uint64>(pid) << 32) | (serial.fetch_add(1, std::memory_order_relaxed) + 1);
+        entry = claimEntry(*static_cast<SharedExportDirectory*>(directoryRegion.getData()), key);
+        if (entry == nullptr || !region.create(SharedExportDirectory::getInstanceName(key), sizeof(SharedExportLayout), true))
+        {
+            close();
+            return false;
+        }
+        layout = new (region.getData()) SharedExportLayout;
+        layout->version = SharedExportLayout::VERSION;
+        layout->numPoints = SharedExportLayout::NUM_POINTS;
+        layout->numSlots = SharedExportLayout::NUM_SLOTS;
+        layout->fftSize = fftSize;
+        layout->ownerPid = static_cast<juce::int32>(pid);
+        std::copy(binIndices.begin(), binIndices.end(), layout->binIndices);
+        layout->published.store(0, std::memory_order_relaxed);
+        for (auto& slot : layout->slots)
+        {
+            slot.sequence.store(0, std::memory_order_relaxed);
+        }
+        layout->magic.store(SharedExportLayout::MAGIC, std::memory_order_release);
+        return true;
+#endif
+    }
+    void close()
+    {
+        if (entry != nullptr)
+        {
+            auto expected = key;
+            entry->compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+        }
+        region.close(true);
+        directoryRegion.close();
+        layout = nullptr;
+        entry = nullptr;
+        key = 0;
+    }
+    bool isOpen() const
+    {
+        return layout != nullptr;
+    }
+    const juce::String& getName() const
+    {
+        return region.getName();
+    }
+    void publish(const float* spectrum, const float* peakHold, float leftDB, float rightDB, double sampleRate)
+    {
+        if (layout == nullptr)
+        {
+            return;
+        }
+        const auto index = layout->published.load(std::memory_order_relaxed);
+        auto& slot = layout->slots[index % SharedExportLayout::NUM_SLOTS];
+        const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.frame.index = index;
+        slot.frame.sampleRate = sampleRate;
+        slot.frame.leftDB = leftDB;
+        slot.frame.rightDB = rightDB;
+        std::memcpy(slot.frame.spectrum, spectrum, sizeof(slot.frame.spectrum));
+        std::memcpy(slot.frame.peakHold, peakHold, sizeof(slot.frame.peakHold));
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        layout->published.store(index + 1, std::memory_order_release);
+    }
+    static int getCurrentPid()
+    {
+#if QUASAR_SHARED_EXPORT_AVAILABLE
+        return static_cast<int>(::getpid());
+#else
+        return 0;
+#endif
+    }
+    static bool isProcessAlive(int pid)
+    {
+#if QUASAR_SHARED_EXPORT_AVAILABLE
+        return ::kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH;
+#else
+        juce::ignoreUnused(pid);
+        return false;
+#endif
+    }
+private:
+    SharedMemoryRegion directoryRegion;
+    SharedMemoryRegion region;
+    SharedExportLayout* layout = nullptr;
+    std::atomic<juce::uint64>* entry = nullptr;
+    juce::uint64 key = 0;
+    static std::atomic<juce::uint64>* claimEntry(SharedExportDirectory& directory, juce::uint64 newKey)
+    {
+        for (auto& candidate : directory.entries)
+        {
+            auto current = candidate.load(std::memory_order_acquire);
+            if (current != 0 && isProcessAlive(SharedExportDirectory::getPid(current)))
+            {
+                continue;
+            }
+            if (candidate.compare_exchange_strong(current, newKey, std::memory_order_acq_rel))
+            {
+                if (current != 0)
+                {
+                    SharedMemoryRegion::remove(SharedExportDirectory::getInstanceName(current));
+                }
+                return &candidate;
+            }
+        }
+        return nullptr;
+    }
+};
+class SharedSpectrumReader
+{
+public:
+    static constexpr int MAX_RETRIES = 64;
+    bool open(const juce::String& name)
+    {
+        layout = nullptr;
+        if (!region.open(name, sizeof(SharedExportLayout)))
+        {
+            return false;
+        }
+        const auto* candidate = static_cast<const SharedExportLayout*>(region.getData());
+        if (candidate->magic.load(std::memory_order_acquire) != SharedExportLayout::MAGIC || candidate->version != SharedExportLayout::VERSION || candidate->numPoints != SharedExportLayout::NUM_POINTS)
+        {
+            region.close();
+            return false;
+        }
+        layout = candidate;
+        return true;
+    }
+    void close()
+    {
+        region.close();
+        layout = nullptr;
+    }
+    bool isOpen() const
+    {
+        return layout != nullptr;
+    }
+    const juce::String& getName() const
+    {
+        return region.getName();
+    }
+    juce::uint64 getNumPublished() const
+    {
+        return layout == nullptr ? 0 : layout->published.load(std::memory_order_acquire);
+    }
+    int getOwnerPid() const
+    {
+        return layout == nullptr ? 0 : layout->ownerPid;
+    }
+    float getFrequency(int point, double sampleRate) const
+    {
+        return static_cast<float>(layout->binIndices[point] * sampleRate / layout->fftSize);
+    }
+    bool readLatest(SharedExportLayout::Frame& frame, int* retries = nullptr) const
+    {
+        if (layout == nullptr)
+        {
+            return false;
+        }
+        for (int attempt = 0; attempt < MAX_RETRIES; ++attempt)
+        {
+            const auto published = layout->published.load(std::memory_order_acquire);
+            if (published == 0)
+            {
+                return false;
+            }
+            const auto index = published - 1;
+            const auto& slot = layout->slots[index % SharedExportLayout::NUM_SLOTS];
+            const auto before = slot.sequence.load(std::memory_order_acquire);
+            if ((before & 1u) == 0)
+            {
+                std::memcpy(&frame, &slot.frame, sizeof(frame));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == before && frame.index == index)
+                {
+                    if (retries != nullptr)
+                    {
+                        *retries += attempt;
+                    }
+                    return true;
+                }
+            }
+        }
+        if (retries != nullptr)
+        {
+            *retries += MAX_RETRIES;
+        }
+        return false;
+    }
+    static juce::StringArray findInstances()
+    {
+        juce::StringArray names;
+        SharedMemoryRegion directoryRegion;
+        if (directoryRegion.open(SharedExportDirectory::NAME, sizeof(SharedExportDirectory)))
+        {
+            const auto& directory = *static_cast<const SharedExportDirectory*>(directoryRegion.getData());
+            for (const auto& entry : directory.entries)
+            {
+                const auto key = entry.load(std::memory_order_acquire);
+                if (key != 0 && SharedSpectrumExport::isProcessAlive(SharedExportDirectory::getPid(key)))
+                {
+                    names.add(SharedExportDirectory::getInstanceName(key));
+                }
+            }
+        }
+        return names;
+    }
+private:
+    SharedMemoryRegion region;
+    const SharedExportLayout* layout = nullptr;
+};
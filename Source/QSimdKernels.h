@@ -0,0 +1,325 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+#include <JuceHeader.h>
+#if JUCE_INTEL
+#include <immintrin.h>
+#endif
+enum class SimdIsa: juce::uint8
+{
+    Sse2, Avx2, Avx512
+};
+static constexpr int NUM_SIMD_ISAS = 3;
+static constexpr int MAX_KERNEL_SECTIONS = 8;
+static inline const juce::String FORCE_ISA_ENVIRONMENT {"QUASAR_FORCE_ISA"};
+struct SvfFrame
+{
+    float a1, a2, a3, m0, m1, m2;
+};
+template <typename Sample>
+struct CascadeKernels
+{
+    using Biquad = void (*)(Sample* frames, int numSamples, const std::array<float, 5>* stages, Sample* states, int sectionStride);
+    using Svf = void (*)(Sample* frames, int numSamples, const SvfFrame* coefficients, Sample* states, int sectionStride);
+    int width = 0;
+    std::array<Biquad, MAX_KERNEL_SECTIONS> biquad {};
+    std::array<Svf, MAX_KERNEL_SECTIONS> svf {};
+    bool isValid() const
+    {
+        return width > 0;
+    }
+};
+struct AnalyzerKernels
+{
+    void (*findMaxima)(const float* source, float* destination, int count, int window);
+    float (*findPeak)(const float* data, int numSamples);
+};
+namespace quasar::simd
+{
+    struct Baseline
+    {
+        static void findMaxima(const float* source, float* destination, int count, int window)
+        {
+            for (int i = 0; i < count; ++i, source += window)
+            {
+                destination[i] = *std::max_element(source, source + window);
+            }
+        }
+        static float findPeak(const float* data, int numSamples)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+            return juce::jmax(range.getStart(), -range.getStart(), range.getEnd(), -range.getEnd());
+        }
+    };
+}
+#if JUCE_INTEL
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+namespace quasar::simd::avx2
+{
+    struct Float4
+    {
+        using Sample = float;
+        using Vector = __m128;
+        static constexpr int WIDTH = 4;
+        static Vector load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+        static Vector expand(float x) { return _mm_set1_ps(x); }
+        static Vector add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+        static Vector subtract(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+        static Vector multiply(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+        static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm_fmadd_ps(a, b, c); }
+        static Vector negativeMultiplyAdd(Vector a, Vector b, Vector c) { return _mm_fnmadd_ps(a, b, c); }
+        static Vector max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+        static Vector abs(Vector v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+        static float reduceMax(Vector v)
+        {
+            v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+            v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 1));
+            return _mm_cvtss_f32(v);
+        }
+        static void finish() {}
+    };
+    struct Float8
+    {
+        using Sample = float;
+        using Vector = __m256;
+        static constexpr int WIDTH = 8;
+        static Vector load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, Vector v) { _mm256_storeu_ps(p, v); }
+        static Vector expand(float x) { return _mm256_set1_ps(x); }
+        static Vector add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+        static Vector subtract(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+        static Vector multiply(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+        static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm256_fmadd_ps(a, b, c); }
+        static Vector negativeMultiplyAdd(Vector a, Vector b, Vector c) { return _mm256_fnmadd_ps(a, b, c); }
+        static Vector max(Vector a, Vector b) { return _mm256_max_ps(a, b); }
+        static Vector abs(Vector v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+        static float reduceMax(Vector v) { return Float4::reduceMax(_mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1))); }
+        static void finish() { _mm256_zeroupper(); }
+    };
+    struct Double2
+    {
+        using Sample = double;
+        using Vector = __m128d;
+        static constexpr int WIDTH = 2;
+        static Vector load(const double* p) { return _mm_loadu_pd(p); }
+        static void store(double* p, Vector v) { _mm_storeu_pd(p, v); }
+        static Vector expand(float x) { return _mm_set1_pd(static_cast<double>(x)); }
+        static Vector add(Vector a, Vector b) { return _mm_add_pd(a, b); }
+        static Vector subtract(Vector a, Vector b) { return _mm_sub_pd(a, b); }
+        static Vector multiply(Vector a, Vector b) { return _mm_mul_pd(a, b); }
+        static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm_fmadd_pd(a, b, c); }
+        static Vector negativeMultiplyAdd(Vector a, Vector b, Vector c) { return _mm_fnmadd_pd(a, b, c); }
+        static void finish() {}
+    };
+    struct Double4
+    {
+        using Sample = double;
+        using Vector = __m256d;
+        static constexpr int WIDTH = 4;
+        static Vector load(const double* p) { return _mm256_loadu_pd(p); }
+        static void store(double* p, Vector v) { _mm256_storeu_pd(p, v); }
+        static Vector expand(float x) { return _mm256_set1_pd(static_cast<double>(x)); }
+        static Vector add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+        static Vector subtract(Vector a, Vector b) { return _mm256_sub_pd(a, b); }
+        static Vector multiply(Vector a, Vector b) { return _mm256_mul_pd(a, b); }
+        static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm256_fmadd_pd(a, b, c); }
+        static Vector negativeMultiplyAdd(Vector a, Vector b, Vector c) { return _mm256_fnmadd_pd(a, b, c); }
+        static void finish() { _mm256_zeroupper(); }
+    };
+#include "QSimdKernels.inl"
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f,avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx2,fma")
+#endif
+namespace quasar::simd::avx512
+{
+    struct Float16
+    {
+        using Sample = float;
+        using Vector = __m512;
+        static constexpr int WIDTH = 16;
+        static Vector load(const float* p) { return _mm512_loadu_ps(p); }
+        static void store(float* p, Vector v) { _mm512_storeu_ps(p, v); }
+        static Vector expand(float x) { return _mm512_set1_ps(x); }
+        static Vector add(Vector a, Vector b) { return _mm512_add_ps(a, b); }
+        static Vector subtract(Vector a, Vector b) { return _mm512_sub_ps(a, b); }
+        static Vector multiply(Vector a, Vector b) { return _mm512_mul_ps(a, b); }
+        static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm512_fmadd_ps(a, b, c); }
+        static Vector negativeMultiplyAdd(Vector a, Vector b, Vector c) { return _mm512_fnmadd_ps(a, b, c); }
+        static Vector max(Vector a, Vector b) { return _mm512_max_ps(a, b); }
+        static Vector abs(Vector v) { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(v), _mm512_set1_epi32(0x7fffffff))); }
+        static float reduceMax(Vector v)
+        {
+            alignas(64) float lanes[WIDTH];
+            _mm512_store_ps(lanes, v);
+            return *std::max_element(lanes, lanes + WIDTH);
+        }
+        static void finish() { _mm256_zeroupper(); }
+    };
+    struct Double8
+    {
+        using Sample = double;
+        using Vector = __m512d;
+        static constexpr int WIDTH = 8;
+        static Vector load(const double* p) { return _mm512_loadu_pd(p); }
+        static void store(double* p, Vector v) { _mm512_storeu_pd(p, v); }
+        static Vector expand(float x) { return _mm512_set1_pd(static_cast<double>(x)); }
+        static Vector add(Vector a, Vector b) { return _mm512_add_pd(a, b); }
+        static Vector subtract(Vector a, Vector b) { return _mm512_sub_pd(a, b); }
+        static Vector multiply(Vector a, Vector b) { return _mm512_mul_pd(a, b); }
+        static Vector multiplyAdd(Vector a, Vector b, Vector c) { return _mm512_fmadd_pd(a, b, c); }
+        static Vector negativeMultiplyAdd(Vector a, Vector b, Vector c) { return _mm512_fnmadd_pd(a, b, c); }
+        static void finish() { _mm256_zeroupper(); }
+    };
+#include "QSimdKernels.inl"
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif
+class SimdDispatch
+{
+public:
+    static bool isSupported(SimdIsa isa)
+    {
+#if JUCE_INTEL
+        switch (isa)
+        {
+            case SimdIsa::Sse2: return true;
+            case SimdIsa::Avx2: return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+            case SimdIsa::Avx512: return isSupported(SimdIsa::Avx2) && juce::SystemStats::hasAVX512F();
+            default: return false;
+        }
+#else
+        return isa == SimdIsa::Sse2;
+#endif
+    }
+    static SimdIsa detect()
+    {
+        for (int i = NUM_SIMD_ISAS - 1; i > 0; --i)
+        {
+            if (isSupported(static_cast<SimdIsa>(i)))
+            {
+                return static_cast<SimdIsa>(i);
+            }
+        }
+        return SimdIsa::Sse2;
+    }
+    static SimdIsa select()
+    {
+        SimdIsa forced;
+        if (parse(juce::SystemStats::getEnvironmentVariable(FORCE_ISA_ENVIRONMENT, {}), forced) && isSupported(forced))
+        {
+            return forced;
+        }
+        return detect();
+    }
+    static const char* getName(SimdIsa isa)
+    {
+        switch (isa)
+        {
+            case SimdIsa::Avx2: return "avx2";
+            case SimdIsa::Avx512: return "avx512";
+            default: return "sse2";
+        }
+    }
+    static bool parse(const juce::String& name, SimdIsa& isa)
+    {
+        for (int i = 0; i < NUM_SIMD_ISAS; ++i)
+        {
+            if (name.trim().equalsIgnoreCase(getName(static_cast<SimdIsa>(i))))
+            {
+                isa = static_cast<SimdIsa>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+    static int getMaxWidth(SimdIsa isa)
+    {
+        return isa == SimdIsa::Avx512 ? 16 : (isa == SimdIsa::Avx2 ? 8 : 4);
+    }
+    static CascadeKernels<float> getCascadeKernels(SimdIsa isa, int width)
+    {
+#if JUCE_INTEL
+        if (isSupported(isa) && isa != SimdIsa::Sse2)
+        {
+            switch (width)
+            {
+                case 4: return makeCascadeKernels<quasar::simd::avx2::Kernels<quasar::simd::avx2::Float4>>();
+                case 8: return makeCascadeKernels<quasar::simd::avx2::Kernels<quasar::simd::avx2::Float8>>();
+                case 16: return isa == SimdIsa::Avx512 ? makeCascadeKernels<quasar::simd::avx512::Kernels<quasar::simd::avx512::Float16>>() : CascadeKernels<float> {};
+                default: break;
+            }
+        }
+#endif
+        juce::ignoreUnused(isa, width);
+        return {};
+    }
+    static CascadeKernels<double> getPreciseCascadeKernels(SimdIsa isa, int width)
+    {
+#if JUCE_INTEL
+        if (isSupported(isa) && isa != SimdIsa::Sse2)
+        {
+            switch (width)
+            {
+                case 2: return makeCascadeKernels<quasar::simd::avx2::Kernels<quasar::simd::avx2::Double2>>();
+                case 4: return makeCascadeKernels<quasar::simd::avx2::Kernels<quasar::simd::avx2::Double4>>();
+                case 8: return isa == SimdIsa::Avx512 ? makeCascadeKernels<quasar::simd::avx512::Kernels<quasar::simd::avx512::Double8>>() : CascadeKernels<double> {};
+                default: break;
+            }
+        }
+#endif
+        juce::ignoreUnused(isa, width);
+        return {};
+    }
+    static AnalyzerKernels getAnalyzerKernels(SimdIsa isa)
+    {
+#if JUCE_INTEL
+        if (isSupported(isa))
+        {
+            switch (isa)
+            {
+                case SimdIsa::Avx2: return {&quasar::simd::avx2::Kernels<quasar::simd::avx2::Float8>::findMaxima, &quasar::simd::avx2::Kernels<quasar::simd::avx2::Float8>::findPeak};
+                case SimdIsa::Avx512: return {&quasar::simd::avx2::Kernels<quasar::simd::avx2::Float8>::findMaxima, &quasar::simd::avx512::Kernels<quasar::simd::avx512::Float16>::findPeak};
+                default: break;
+            }
+        }
+#endif
+        return {&quasar::simd::Baseline::findMaxima, &quasar::simd::Baseline::findPeak};
+    }
+private:
+    template <typename KernelSet, size_t... Sections>
+    static CascadeKernels<typename KernelSet::Sample> makeCascadeKernels(std::index_sequence<Sections...>)
+    {
+        CascadeKernels<typename KernelSet::Sample> kernels;
+        kernels.width = KernelSet::WIDTH;
+        kernels.biquad = {&KernelSet::template processBiquadCascade<static_cast<int>(Sections) + 1>...};
+        kernels.svf = {&KernelSet::template processSvfCascade<static_cast<int>(Sections) + 1>...};
+        return kernels;
+    }
+    template <typename KernelSet>
+    static CascadeKernels<typename KernelSet::Sample> makeCascadeKernels()
+    {
+        return makeCascadeKernels<KernelSet>(std::make_index_sequence<MAX_KERNEL_SECTIONS>());
+    }
+};
@@ -0,0 +1,116 @@
+template <typename Ops>
+struct Kernels
+{
+    using Sample = typename Ops::Sample;
+    static constexpr int WIDTH = Ops::WIDTH;
+    template <int Sections>
+    static void processBiquadCascade(Sample* frames, int numSamples, const std::array<float, 5>* stages, Sample* states, int sectionStride)
+    {
+        using Vector = typename Ops::Vector;
+        Vector b0[Sections], b1[Sections], b2[Sections], a1[Sections], a2[Sections], s1[Sections], s2[Sections];
+        for (int section = 0; section < Sections; ++section)
+        {
+            const float* c = stages[section].data();
+            b0[section] = Ops::expand(c[0]);
+            b1[section] = Ops::expand(c[1]);
+            b2[section] = Ops::expand(c[2]);
+            a1[section] = Ops::expand(c[3]);
+            a2[section] = Ops::expand(c[4]);
+            s1[section] = Ops::load(states + section * sectionStride);
+            s2[section] = Ops::load(states + section * sectionStride + Ops::WIDTH);
+        }
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = Ops::load(frames + i * Ops::WIDTH);
+            for (int section = 0; section < Sections; ++section)
+            {
+                const auto y = Ops::multiplyAdd(b0[section], x, s1[section]);
+                s1[section] = Ops::multiplyAdd(b1[section], x, Ops::negativeMultiplyAdd(a1[section], y, s2[section]));
+                s2[section] = Ops::negativeMultiplyAdd(a2[section], y, Ops::multiply(b2[section], x));
+                x = y;
+            }
+            Ops::store(frames + i * Ops::WIDTH, x);
+        }
+        for (int section = 0; section < Sections; ++section)
+        {
+            Ops::store(states + section * sectionStride, s1[section]);
+            Ops::store(states + section * sectionStride + Ops::WIDTH, s2[section]);
+        }
+        Ops::finish();
+    }
+    template <int Sections>
+    static void processSvfCascade(Sample* frames, int numSamples, const SvfFrame* coefficients, Sample* states, int sectionStride)
+    {
+        using Vector = typename Ops::Vector;
+        Vector a1[Sections], a2[Sections], a3[Sections], m0[Sections], m1[Sections], m2[Sections], s1[Sections], s2[Sections];
+        for (int section = 0; section < Sections; ++section)
+        {
+            const auto& f = coefficients[section];
+            a1[section] = Ops::expand(f.a1);
+            a2[section] = Ops::expand(f.a2);
+            a3[section] = Ops::expand(f.a3);
+            m0[section] = Ops::expand(f.m0);
+            m1[section] = Ops::expand(f.m1);
+            m2[section] = Ops::expand(f.m2);
+            s1[section] = Ops::load(states + section * sectionStride);
+            s2[section] = Ops::load(states + section * sectionStride + Ops::WIDTH);
+        }
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = Ops::load(frames + i * Ops::WIDTH);
+            for (int section = 0; section < Sections; ++section)
+            {
+                const auto v3 = Ops::subtract(x, s2[section]);
+                const auto v1 = Ops::multiplyAdd(a1[section], s1[section], Ops::multiply(a2[section], v3));
+                const auto v2 = Ops::multiplyAdd(a3[section], v3, Ops::multiplyAdd(a2[section], s1[section], s2[section]));
+                s1[section] = Ops::subtract(Ops::add(v1, v1), s1[section]);
+                s2[section] = Ops::subtract(Ops::add(v2, v2), s2[section]);
+                x = Ops::multiplyAdd(m2[section], v2, Ops::multiplyAdd(m1[section], v1, Ops::multiply(m0[section], x)));
+            }
+            Ops::store(frames + i * Ops::WIDTH, x);
+        }
+        for (int section = 0; section < Sections; ++section)
+        {
+            Ops::store(states + section * sectionStride, s1[section]);
+            Ops::store(states + section * sectionStride + Ops::WIDTH, s2[section]);
+        }
+        Ops::finish();
+    }
+    static void findMaxima(const float* source, float* destination, int count, int window)
+    {
+        if (window < Ops::WIDTH)
+        {
+            for (int i = 0; i < count; ++i, source += window)
+            {
+                destination[i] = *std::max_element(source, source + window);
+            }
+            return;
+        }
+        for (int i = 0; i < count; ++i, source += window)
+        {
+            auto maximum = Ops::load(source);
+            for (int j = Ops::WIDTH; j < window; j += Ops::WIDTH)
+            {
+                maximum = Ops::max(maximum, Ops::load(source + j));
+            }
+            destination[i] = Ops::reduceMax(maximum);
+        }
+        Ops::finish();
+    }
+    static float findPeak(const float* data, int numSamples)
+    {
+        auto maximum = Ops::expand(0.0f);
+        int i = 0;
+        for (; i + Ops::WIDTH <= numSamples; i += Ops::WIDTH)
+        {
+            maximum = Ops::max(maximum, Ops::abs(Ops::load(data + i)));
+        }
+        float peak = Ops::reduceMax(maximum);
+        for (; i < numSamples; ++i)
+        {
+            peak = std::max(peak, std::abs(data[i]));
+        }
+        Ops::finish();
+        return peak;
+    }
+};
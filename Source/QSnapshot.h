@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <JuceHeader.h>
+#include "QFilterBank.h"
+#include "QDynamics.h"
+#include "QStateFormat.h"
+template <int NumBands>
+struct PresetSnapshot
+{
+    BinaryState<NumBands> state;
+    std::array<FilterCascade, NumBands> coefficients;
+    std::array<bool, NumBands> bypassed;
+    std::array<BandRouting, NumBands> routings;
+    std::array<BandTopology, NumBands> topologies;
+    std::array<DynamicBandSettings, NumBands> dynamics;
+    float gainDecibels = 0.0f;
+    bool globalBypass = false;
+    double sampleRate = 0.0;
+};
+struct SnapshotReclaimer: public juce::TimeSliceThread
+{
+    SnapshotReclaimer(): juce::TimeSliceThread("Snapshot Reclaimer")
+    {
+        startThread(juce::Thread::Priority::background);
+    }
+    ~SnapshotReclaimer() override
+    {
+        stopThread(1000);
+    }
+};
+template <typename Snapshot>
+class SnapshotExchange: private juce::TimeSliceClient
+{
+public:
+    SnapshotExchange()
+    {
+        reclaimer->addTimeSliceClient(this);
+    }
+    ~SnapshotExchange() override
+    {
+        reclaimer->removeTimeSliceClient(this);
+        delete pending.exchange(nullptr);
+        reclaim();
+    }
+    void publish(std::unique_ptr<Snapshot> snapshot)
+    {
+        delete pending.exchange(snapshot.release(), std::memory_order_acq_rel);
+    }
+    Snapshot* acquire()
+    {
+        if (retired.getFreeSpace() == 0)
+        {
+            return nullptr;
+        }
+        return pending.exchange(nullptr, std::memory_order_acq_rel);
+    }
+    void retire(Snapshot* snapshot)
+    {
+        const auto write = retired.write(1);
+        if (write.blockSize1 > 0)
+        {
+            retiredSlots[static_cast<size_t>(write.startIndex1)] = snapshot;
+        }
+    }
+private:
+    static constexpr int RETIRE_CAPACITY = 16;
+    static constexpr int RECLAIM_INTERVAL_MS = 50;
+    std::atomic<Snapshot*> pending {nullptr};
+    std::array<Snapshot*, RETIRE_CAPACITY> retiredSlots {};
+    juce::AbstractFifo retired {RETIRE_CAPACITY};
+    juce::SharedResourcePointer<SnapshotReclaimer> reclaimer;
+    void reclaim()
+    {
+        const auto read = retired.read(retired.getNumReady());
+        for (int i = 0; i < read.blockSize1; ++i)
+        {
+            delete retiredSlots[static_cast<size_t>(read.startIndex1 + i)];
+        }
+        for (int i = 0; i < read.blockSize2; ++i)
+        {
+            delete retiredSlots[static_cast<size_t>(read.startIndex2 + i)];
+        }
+    }
+    int useTimeSlice() override
+    {
+        reclaim();
+        return RECLAIM_INTERVAL_MS;
+    }
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <JuceHeader.h>
+class SpectrogramComponent: public juce::Component
+{
+public:
+    SpectrogramComponent()
+    {
+        const juce::ColourGradient gradient(juce::Colours::black, 0.0f, 0.0f, juce::Colour(0xff7391ff), 1.0f, 0.0f, false);
+        for (int i = 0; i < COLOUR_LUT_SIZE; ++i)
+        {
+            auto colour = gradient.getColourAtPosition(static_cast<double>(i) / (COLOUR_LUT_SIZE - 1));
+            if (i > (COLOUR_LUT_SIZE * 3) / 4)
+            {
+                colour = colour.interpolatedWith(juce::Colours::white, static_cast<float>(i - (COLOUR_LUT_SIZE * 3) / 4) / (COLOUR_LUT_SIZE / 4));
+            }
+            colourLUT[i] = colour.getPixelARGB();
+        }
+        rowToBin.fill(0);
+    };
+    void setFrequencyMapping(const std::vector<float>& freqLUT)
+    {
+        if (freqLUT.size() < 2)
+        {
+            return;
+        }
+        for (int row = 0; row < HISTORY_ROWS; ++row)
+        {
+            const float position = 1.0f - (static_cast<float>(row) + 0.5f) / HISTORY_ROWS;
+            const auto it = std::upper_bound(freqLUT.begin() + 1, freqLUT.end(), position);
+            rowToBin[row] = juce::jlimit(1, static_cast<int>(freqLUT.size()) - 1, static_cast<int>(std::distance(freqLUT.begin(), it)) - 1);
+        }
+        mappingSize = freqLUT.size();
+    };
+    void pushFrame(const std::vector<float>& decibels)
+    {
+        if (mappingSize == 0 || decibels.size() < mappingSize)
+        {
+            return;
+        }
+        {
+            juce::Image::BitmapData pixels(history, writeColumn, 0, 1, HISTORY_ROWS, juce::Image::BitmapData::writeOnly);
+            for (int row = 0; row < HISTORY_ROWS; ++row)
+            {
+                const float level = juce::jmap(decibels[rowToBin[row]], MIN_DBFS, MAX_DBFS, 0.0f, static_cast<float>(COLOUR_LUT_SIZE - 1));
+                const int index = juce::jlimit(0, COLOUR_LUT_SIZE - 1, static_cast<int>(level));
+                *reinterpret_cast<juce::PixelARGB*>(pixels.getPixelPointer(0, row)) = colourLUT[index];
+            }
+        }
+        writeColumn = (writeColumn + 1) % HISTORY_COLUMNS;
+        repaint();
+    };
+    void paint(juce::Graphics& g) override
+    {
+        auto area = getLocalBounds().reduced(margin << 1, margin);
+        area.removeFromRight(margin * 6);
+        g.setColour(juce::Colours::black);
+        g.fillRect(area);
+        const int oldestColumns = HISTORY_COLUMNS - writeColumn;
+        const int oldestWidth = juce::roundToInt(area.getWidth() * static_cast<float>(oldestColumns) / HISTORY_COLUMNS);
+        g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+        if (oldestColumns > 0 && oldestWidth > 0)
+        {
+            g.drawImage(history, area.getX(), area.getY(), oldestWidth, area.getHeight(), writeColumn, 0, oldestColumns, HISTORY_ROWS);
+        }
+        if (writeColumn > 0 && area.getWidth() - oldestWidth > 0)
+        {
+            g.drawImage(history, area.getX() + oldestWidth, area.getY(), area.getWidth() - oldestWidth, area.getHeight(), 0, 0, writeColumn, HISTORY_ROWS);
+        }
+        g.setColour(juce::Colours::dimgrey.withAlpha(0.5f));
+        g.drawRect(area);
+    };
+private:
+    static constexpr int HISTORY_SECONDS = 10;
+    static constexpr int FRAMES_PER_SECOND = 50;
+    static constexpr int HISTORY_COLUMNS = HISTORY_SECONDS * FRAMES_PER_SECOND;
+    static constexpr int HISTORY_ROWS = 256;
+    static constexpr int COLOUR_LUT_SIZE = 256;
+    static constexpr float MIN_DBFS = -90.0f;
+    static constexpr float MAX_DBFS = 0.0f;
+    static constexpr int margin = 10;
+    juce::Image history {juce::Image::ARGB, HISTORY_COLUMNS, HISTORY_ROWS, true, juce::SoftwareImageType()};
+    std::array<juce::PixelARGB, COLOUR_LUT_SIZE> colourLUT;
+    std::array<int, HISTORY_ROWS> rowToBin;
+    size_t mappingSize = 0;
+    int writeColumn = 0;
+};
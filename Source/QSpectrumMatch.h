@@ -0,0 +1,390 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <JuceHeader.h>
+#include "QFilterDesign.h"
+class LongTermSpectrum
+{
+public:
+    static constexpr int NUM_POINTS = 120;
+    static constexpr float MIN_HZ = 20.0f;
+    static constexpr float MAX_HZ = 20000.0f;
+    static constexpr int FFT_ORDER = 12;
+    static constexpr int FFT_SIZE = 1 << FFT_ORDER;
+    static constexpr int NUM_BINS = FFT_SIZE / 2;
+    static constexpr int HOP_SIZE = FFT_SIZE / 2;
+    static float getFrequency(int point)
+    {
+        return MIN_HZ * std::pow(MAX_HZ / MIN_HZ, static_cast<float>(point) / (NUM_POINTS - 1));
+    }
+    static std::vector<float> getFrequencies()
+    {
+        std::vector<float> frequencies(NUM_POINTS);
+        for (int i = 0; i < NUM_POINTS; ++i)
+        {
+            frequencies[static_cast<size_t>(i)] = getFrequency(i);
+        }
+        return frequencies;
+    }
+    void reset()
+    {
+        const juce::ScopedLock lock(accumulatorLock);
+        sums.fill(0.0);
+        numFrames = 0;
+    }
+    void addFrame(const float* magnitudes, int numBins, double sampleRate)
+    {
+        const juce::ScopedLock lock(accumulatorLock);
+        if (sampleRate != mappedSampleRate || numBins != mappedBins)
+        {
+            mapBins(sampleRate, numBins);
+        }
+        for (int p = 0; p < NUM_POINTS; ++p)
+        {
+            double power = 0.0;
+            for (int bin = firstBins[static_cast<size_t>(p)]; bin <= lastBins[static_cast<size_t>(p)]; ++bin)
+            {
+                power += static_cast<double>(magnitudes[bin]) * magnitudes[bin];
+            }
+            sums[static_cast<size_t>(p)] += power / (lastBins[static_cast<size_t>(p)] - firstBins[static_cast<size_t>(p)] + 1);
+        }
+        ++numFrames;
+    }
+    juce::int64 getNumFrames() const
+    {
+        const juce::ScopedLock lock(accumulatorLock);
+        return numFrames;
+    }
+    std::vector<float> getDecibels() const
+    {
+        const juce::ScopedLock lock(accumulatorLock);
+        std::vector<float> decibels(NUM_POINTS, MIN_DB);
+        if (numFrames > 0)
+        {
+            for (int p = 0; p < NUM_POINTS; ++p)
+            {
+                const double power = sums[static_cast<size_t>(p)] / static_cast<double>(numFrames);
+                decibels[static_cast<size_t>(p)] = static_cast<float>(juce::jmax(static_cast<double>(MIN_DB), 10.0 * std::log10(power + 1.0e-30)));
+            }
+        }
+        return decibels;
+    }
+    bool analyse(juce::AudioFormatReader& reader)
+    {
+        reset();
+        juce::dsp::FFT fft {FFT_ORDER};
+        juce::dsp::WindowingFunction<float> windowing {size_t(FFT_SIZE), juce::dsp::WindowingFunction<float>::blackmanHarris, true};
+        const int numChannels = juce::jlimit(1, 2, static_cast<int>(reader.numChannels));
+        juce::AudioBuffer<float> hop(numChannels, HOP_SIZE);
+        std::vector<float> history(FFT_SIZE, 0.0f);
+        std::vector<float> fftData(FFT_SIZE * 2, 0.0f);
+        for (juce::int64 position = 0; position < reader.lengthInSamples; position += HOP_SIZE)
+        {
+            const int numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(HOP_SIZE), reader.lengthInSamples - position));
+            hop.clear();
+            if (!reader.read(&hop, 0, numSamples, position, true, true))
+            {
+                return false;
+            }
+            std::copy(history.begin() + HOP_SIZE, history.end(), history.begin());
+            auto* tail = history.data() + FFT_SIZE - HOP_SIZE;
+            juce::FloatVectorOperations::copy(tail, hop.getReadPointer(0), HOP_SIZE);
+            if (numChannels == 2)
+            {
+                juce::FloatVectorOperations::add(tail, hop.getReadPointer(1), HOP_SIZE);
+                juce::FloatVectorOperations::multiply(tail, 0.5f, HOP_SIZE);
+            }
+            std::fill(fftData.begin(), fftData.end(), 0.0f);
+            std::copy(history.begin(), history.end(), fftData.begin());
+            windowing.multiplyWithWindowingTable(fftData.data(), FFT_SIZE);
+            fft.performFrequencyOnlyForwardTransform(fftData.data());
+            juce::FloatVectorOperations::multiply(fftData.data(), 1.0f / NUM_BINS, NUM_BINS);
+            addFrame(fftData.data(), NUM_BINS, reader.sampleRate);
+        }
+        return getNumFrames() > 0;
+    }
+private:
+    static constexpr float MIN_DB = -200.0f;
+    juce::CriticalSection accumulatorLock;
+    std::array<double, NUM_POINTS> sums {};
+    std::array<int, NUM_POINTS> firstBins {};
+    std::array<int, NUM_POINTS> lastBins {};
+    juce::int64 numFrames = 0;
+    double mappedSampleRate = 0.0;
+    int mappedBins = 0;
+    void mapBins(double sampleRate, int numBins)
+    {
+        mappedSampleRate = sampleRate;
+        mappedBins = numBins;
+        const double binWidth = sampleRate / (2.0 * numBins);
+        const double halfStep = std::sqrt(std::pow(static_cast<double>(MAX_HZ / MIN_HZ), 1.0 / (NUM_POINTS - 1)));
+        for (int p = 0; p < NUM_POINTS; ++p)
+        {
+            const double centre = getFrequency(p);
+            int first = static_cast<int>(std::ceil(centre / halfStep / binWidth));
+            int last = static_cast<int>(std::floor(centre * halfStep / binWidth));
+            if (first > last)
+            {
+                first = last = static_cast<int>(std::round(centre / binWidth));
+            }
+            firstBins[static_cast<size_t>(p)] = juce::jlimit(1, numBins - 1, first);
+            lastBins[static_cast<size_t>(p)] = juce::jlimit(firstBins[static_cast<size_t>(p)], numBins - 1, last);
+        }
+    }
+};
+struct MatchedBand
+{
+    bool enabled = false;
+    int type = static_cast<int>(FilterType::Peak);
+    float freq = 1000.0f;
+    float gain = 0.0f;
+    float q = 1.0f;
+};
+struct MatchLimits
+{
+    float minFreq;
+    float maxFreq;
+    float minGain;
+    float maxGain;
+    float minQ;
+    float maxQ;
+};
+template <int NumBands>
+class SpectrumMatcher
+{
+public:
+    static constexpr int NUM_POINTS = LongTermSpectrum::NUM_POINTS;
+    static constexpr int SMOOTHING_POINTS = 2;
+    static constexpr int REFINE_SWEEPS = 6;
+    static constexpr int MAX_ITERATIONS = 64;
+    static constexpr float MIN_CORRECTION_DB = 0.25f;
+    static constexpr float EDGE_WEIGHT = 0.25f;
+    static constexpr float EDGE_LOW_HZ = 30.0f;
+    static constexpr float EDGE_HIGH_HZ = 16000.0f;
+    SpectrumMatcher(double sampleRate, const MatchLimits& matchLimits): sr(sampleRate), limits(matchLimits)
+    {
+        limits.maxFreq = juce::jmin(limits.maxFreq, static_cast<float>(sr * 0.49));
+        const auto frequencies = LongTermSpectrum::getFrequencies();
+        model.prepare(frequencies.data(), NUM_POINTS, sr);
+        for (int i = 0; i < NUM_POINTS; ++i)
+        {
+            const float f = frequencies[static_cast<size_t>(i)];
+            weights[static_cast<size_t>(i)] = f < EDGE_LOW_HZ || f > EDGE_HIGH_HZ || f > limits.maxFreq ? EDGE_WEIGHT : 1.0f;
+        }
+    }
+    std::array<MatchedBand, NumBands> fit(const std::vector<float>& referenceDecibels, const std::vector<float>& targetDecibels)
+    {
+        setGoal(referenceDecibels, targetDecibels);
+        std::array<MatchedBand, NumBands> bands;
+        total.fill(0.0f);
+        for (auto& curve : curves)
+        {
+            curve.fill(0.0f);
+        }
+        for (int b = 0; b < NumBands; ++b)
+        {
+            int worst = 0;
+            float worstError = 0.0f;
+            for (int i = 0; i < NUM_POINTS; ++i)
+            {
+                const float error = weights[static_cast<size_t>(i)] * std::abs(goal[static_cast<size_t>(i)] - total[static_cast<size_t>(i)]);
+                if (error > worstError)
+                {
+                    worstError = error;
+                    worst = i;
+                }
+            }
+            if (worstError < MIN_CORRECTION_DB)
+            {
+                break;
+            }
+            const float freq = LongTermSpectrum::getFrequency(worst);
+            const float gain = goal[static_cast<size_t>(worst)] - total[static_cast<size_t>(worst)];
+            std::vector<MatchedBand> candidates {{true, static_cast<int>(FilterType::Peak), freq, gain, 1.0f}};
+            if (worst < NUM_POINTS / 6)
+            {
+                candidates.push_back({true, static_cast<int>(FilterType::LowShelf), freq, gain, juce::MathConstants<float>::sqrt2 * 0.5f});
+            }
+            if (worst >= NUM_POINTS * 5 / 6)
+            {
+                candidates.push_back({true, static_cast<int>(FilterType::HighShelf), freq, gain, juce::MathConstants<float>::sqrt2 * 0.5f});
+            }
+            float bestError = std::numeric_limits<float>::max();
+            for (auto candidate : candidates)
+            {
+                const float error = optimiseBand(candidate, total, scratchCurve);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bands[static_cast<size_t>(b)] = candidate;
+                    curves[static_cast<size_t>(b)] = scratchCurve;
+                }
+            }
+            for (int i = 0; i < NUM_POINTS; ++i)
+            {
+                total[static_cast<size_t>(i)] += curves[static_cast<size_t>(b)][static_cast<size_t>(i)];
+            }
+        }
+        for (int sweep = 0; sweep < REFINE_SWEEPS; ++sweep)
+        {
+            for (int b = 0; b < NumBands; ++b)
+            {
+                auto& band = bands[static_cast<size_t>(b)];
+                if (!band.enabled)
+                {
+                    continue;
+                }
+                auto& curve = curves[static_cast<size_t>(b)];
+                for (int i = 0; i < NUM_POINTS; ++i)
+                {
+                    others[static_cast<size_t>(i)] = total[static_cast<size_t>(i)] - curve[static_cast<size_t>(i)];
+                }
+                optimiseBand(band, others, curve);
+                for (int i = 0; i < NUM_POINTS; ++i)
+                {
+                    total[static_cast<size_t>(i)] = others[static_cast<size_t>(i)] + curve[static_cast<size_t>(i)];
+                }
+            }
+        }
+        residual = std::sqrt(getError(total) / weightSum);
+        return bands;
+    }
+    float getResidualDecibels() const
+    {
+        return residual;
+    }
+    const std::array<float, NUM_POINTS>& getGoal() const
+    {
+        return goal;
+    }
+private:
+    using Curve = std::array<float, NUM_POINTS>;
+    const double sr;
+    MatchLimits limits;
+    ResponseModel model;
+    Curve weights;
+    Curve goal;
+    Curve total;
+    Curve others;
+    Curve scratchCurve;
+    Curve trialCurve;
+    std::array<Curve, NumBands> curves;
+    float weightSum = 0.0f;
+    float residual = 0.0f;
+    void setGoal(const std::vector<float>& referenceDecibels, const std::vector<float>& targetDecibels)
+    {
+        Curve difference;
+        for (int i = 0; i < NUM_POINTS; ++i)
+        {
+            difference[static_cast<size_t>(i)] = referenceDecibels[static_cast<size_t>(i)] - targetDecibels[static_cast<size_t>(i)];
+        }
+        float mean = 0.0f;
+        weightSum = 0.0f;
+        for (int i = 0; i < NUM_POINTS; ++i)
+        {
+            float sum = 0.0f;
+            int count = 0;
+            for (int j = juce::jmax(0, i - SMOOTHING_POINTS); j <= juce::jmin(NUM_POINTS - 1, i + SMOOTHING_POINTS); ++j)
+            {
+                sum += difference[static_cast<size_t>(j)];
+                ++count;
+            }
+            goal[static_cast<size_t>(i)] = sum / count;
+            mean += weights[static_cast<size_t>(i)] * goal[static_cast<size_t>(i)];
+            weightSum += weights[static_cast<size_t>(i)];
+        }
+        mean /= weightSum;
+        for (auto& g : goal)
+        {
+            g = juce::jlimit(limits.minGain, limits.maxGain, g - mean);
+        }
+    }
+    float getError(const Curve& curve) const
+    {
+        float error = 0.0f;
+        for (int i = 0; i < NUM_POINTS; ++i)
+        {
+            const float d = goal[static_cast<size_t>(i)] - curve[static_cast<size_t>(i)];
+            error += weights[static_cast<size_t>(i)] * d * d;
+        }
+        return error;
+    }
+    float evaluate(const MatchedBand& band, const Curve& base, Curve& curve)
+    {
+        const auto coefficients = designBand(BandTopology::Biquad, band.type, sr, band.freq, band.q, juce::Decibels::decibelsToGain(band.gain));
+        model.getDecibels(coefficients, curve.data());
+        float error = 0.0f;
+        for (int i = 0; i < NUM_POINTS; ++i)
+        {
+            const float d = goal[static_cast<size_t>(i)] - base[static_cast<size_t>(i)] - curve[static_cast<size_t>(i)];
+            error += weights[static_cast<size_t>(i)] * d * d;
+        }
+        return error;
+    }
+    MatchedBand clampBand(MatchedBand band) const
+    {
+        band.freq = juce::jlimit(limits.minFreq, limits.maxFreq, band.freq);
+        band.gain = juce::jlimit(limits.minGain, limits.maxGain, band.gain);
+        band.q = juce::jlimit(limits.minQ, limits.maxQ, band.q);
+        return band;
+    }
+    float optimiseBand(MatchedBand& band, const Curve& base, Curve& curve)
+    {
+        static constexpr std::array<float, 3> initialSteps {0.5f, 2.0f, 0.5f};
+        static constexpr std::array<float, 3> minimumSteps {1.0f / 48.0f, 0.05f, 1.0f / 32.0f};
+        auto steps = initialSteps;
+        band = clampBand(band);
+        float error = evaluate(band, base, curve);
+        for (int iteration = 0; iteration < MAX_ITERATIONS; ++iteration)
+        {
+            bool improved = false;
+            for (size_t parameter = 0; parameter < steps.size() && !improved; ++parameter)
+            {
+                for (const float direction : {1.0f, -1.0f})
+                {
+                    auto trial = band;
+                    const float step = direction * steps[parameter];
+                    if (parameter == 0)
+                    {
+                        trial.freq *= std::exp2(step);
+                    }
+                    else if (parameter == 1)
+                    {
+                        trial.gain += step;
+                    }
+                    else
+                    {
+                        trial.q *= std::exp2(step);
+                    }
+                    trial = clampBand(trial);
+                    const float trialError = evaluate(trial, base, trialCurve);
+                    if (trialError < error)
+                    {
+                        band = trial;
+                        error = trialError;
+                        curve = trialCurve;
+                        improved = true;
+                        break;
+                    }
+                }
+            }
+            if (!improved)
+            {
+                bool converged = true;
+                for (size_t parameter = 0; parameter < steps.size(); ++parameter)
+                {
+                    steps[parameter] *= 0.5f;
+                    converged = converged && steps[parameter] < minimumSteps[parameter];
+                }
+                if (converged)
+                {
+                    break;
+                }
+            }
+        }
+        return error;
+    }
+};
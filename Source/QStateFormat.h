@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <JuceHeader.h>
+template <int NumBands>
+struct BinaryState
+{
+    static constexpr juce::uint32 MAGIC = 0x42525351;
+    static constexpr juce::uint16 VERSION = 5;
+    static constexpr juce::uint16 HEADER_SIZE = 20;
+    static constexpr juce::uint16 BAND_RECORD_SIZE = 36;
+    static constexpr juce::uint16 LEGACY_BAND_RECORD_SIZE = 16;
+    struct Band
+    {
+        float freq = 0.0f;
+        float gain = 0.0f;
+        float q = 0.0f;
+        juce::uint8 type = 0;
+        juce::uint8 bypass = 0;
+        juce::uint8 route = 0;
+        juce::uint8 topology = 0;
+        juce::uint8 dynamic = 0;
+        juce::uint8 slope = 0;
+        float threshold = 0.0f;
+        float ratio = 1.0f;
+        float attack = 0.0f;
+        float release = 0.0f;
+    };
+    float outGain = 0.0f;
+    juce::uint8 bypass = 0;
+    juce::uint8 analyzerTap = 0;
+    juce::uint8 idleSleep = 0;
+    juce::uint8 snapshotFade = 0;
+    std::array<Band, NumBands> bands;
+    static bool isBinaryState(const void* data, int sizeInBytes)
+    {
+        return sizeInBytes >= HEADER_SIZE && juce::ByteOrder::littleEndianInt(data) == MAGIC;
+    }
+    void write(juce::MemoryBlock& destData) const
+    {
+        destData.setSize(0);
+        destData.ensureSize(HEADER_SIZE + BAND_RECORD_SIZE * NumBands);
+        juce::MemoryOutputStream stream(destData, false);
+        stream.writeInt(static_cast<int>(MAGIC));
+        stream.writeShort(static_cast<short>(VERSION));
+        stream.writeShort(static_cast<short>(HEADER_SIZE));
+        stream.writeShort(static_cast<short>(NumBands));
+        stream.writeShort(static_cast<short>(BAND_RECORD_SIZE));
+        stream.writeFloat(outGain);
+        stream.writeByte(static_cast<char>(bypass));
+        stream.writeByte(static_cast<char>(analyzerTap));
+        stream.writeByte(static_cast<char>(idleSleep));
+        stream.writeByte(static_cast<char>(snapshotFade));
+        for (const auto& band : bands)
+        {
+            stream.writeFloat(band.freq);
+            stream.writeFloat(band.gain);
+            stream.writeFloat(band.q);
+            stream.writeByte(static_cast<char>(band.type));
+            stream.writeByte(static_cast<char>(band.bypass));
+            stream.writeByte(static_cast<char>(band.route));
+            stream.writeByte(static_cast<char>(band.topology));
+            stream.writeByte(static_cast<char>(band.dynamic));
+            stream.writeByte(static_cast<char>(band.slope));
+            stream.writeByte(0);
+            stream.writeByte(0);
+            stream.writeFloat(band.threshold);
+            stream.writeFloat(band.ratio);
+            stream.writeFloat(band.attack);
+            stream.writeFloat(band.release);
+        }
+    }
+    bool read(const void* data, int sizeInBytes)
+    {
+        if (!isBinaryState(data, sizeInBytes))
+        {
+            return false;
+        }
+        juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+        stream.readInt();
+        const int version = static_cast<juce::uint16>(stream.readShort());
+        const int headerSize = static_cast<juce::uint16>(stream.readShort());
+        const int numBands = static_cast<juce::uint16>(stream.readShort());
+        const int bandRecordSize = static_cast<juce::uint16>(stream.readShort());
+        const int minimumRecordSize = version >= 4 ? BAND_RECORD_SIZE : LEGACY_BAND_RECORD_SIZE;
+        if (version < 1 || headerSize < HEADER_SIZE || bandRecordSize < minimumRecordSize || sizeInBytes < headerSize + numBands * bandRecordSize)
+        {
+            return false;
+        }
+        outGain = stream.readFloat();
+        bypass = static_cast<juce::uint8>(stream.readByte());
+        analyzerTap = static_cast<juce::uint8>(stream.readByte());
+        idleSleep = static_cast<juce::uint8>(stream.readByte());
+        if (version >= 2)
+        {
+            snapshotFade = static_cast<juce::uint8>(stream.readByte());
+        }
+        for (int i = 0; i < juce::jmin(numBands, NumBands); ++i)
+        {
+            auto& band = bands[static_cast<size_t>(i)];
+            stream.setPosition(headerSize + i * bandRecordSize);
+            band.freq = stream.readFloat();
+            band.gain = stream.readFloat();
+            band.q = stream.readFloat();
+            band.type = static_cast<juce::uint8>(stream.readByte());
+            band.bypass = static_cast<juce::uint8>(stream.readByte());
+            band.route = static_cast<juce::uint8>(stream.readByte());
+            if (version >= 3)
+            {
+                band.topology = static_cast<juce::uint8>(stream.readByte());
+            }
+            if (version >= 4)
+            {
+                band.dynamic = static_cast<juce::uint8>(stream.readByte());
+                const auto slope = static_cast<juce::uint8>(stream.readByte());
+                if (version >= 5)
+                {
+                    band.slope = slope;
+                }
+                stream.skipNextBytes(2);
+                band.threshold = stream.readFloat();
+                band.ratio = stream.readFloat();
+                band.attack = stream.readFloat();
+                band.release = stream.readFloat();
+            }
+        }
+        return true;
+    }
+};
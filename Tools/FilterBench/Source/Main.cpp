@@ -0,0 +1,339 @@
+#include <JuceHeader.h>
+#include "../../../Source/QFilterDesign.h"
+#include "../../../Source/QDynamics.h"
+#include "../../../Source/QRealtimeCheck.h"
+
+namespace
+{
+    constexpr int NUM_BANDS = 8;
+    constexpr int NUM_CHANNELS = 2;
+    constexpr int NUM_SURROUND_CHANNELS = 16;
+    constexpr int BLOCK_SIZE = 256;
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr double SECONDS = 20.0;
+    constexpr double LFO_RATE = 2.0;
+    constexpr float DYNAMIC_THRESHOLD = -30.0f;
+    constexpr float DYNAMIC_RATIO = 4.0f;
+    using Bank = MultiChannelFilterBank<NUM_BANDS, NUM_CHANNELS>;
+    using Dynamics = DynamicEq<NUM_BANDS>;
+    struct Result
+    {
+        double nanosecondsPerSample = 0.0;
+        double realtimeFactor = 0.0;
+    };
+    float getBandFrequency(int band, double modulation)
+    {
+        const double base = 60.0 * std::pow(2.0, band * 1.2);
+        return static_cast<float>(base * std::pow(2.0, modulation));
+    }
+    void designAll(Bank& bank, BandTopology topology, double modulation, bool glide)
+    {
+        for (int band = 0; band < NUM_BANDS; ++band)
+        {
+            const auto type = static_cast<int>(FilterType::Peak);
+            const auto coefficients = designBand(topology, type, SAMPLE_RATE, getBandFrequency(band, modulation), 1.0f, juce::Decibels::decibelsToGain(6.0f));
+            if (glide)
+            {
+                bank.glideTo(band, coefficients, BLOCK_SIZE);
+            }
+            else
+            {
+                bank.setCoefficients(band, coefficients);
+            }
+        }
+    }
+    void fillNoise(juce::AudioBuffer<float>& buffer, juce::Random& random)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* data = buffer.getWritePointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                data[i] = random.nextFloat() * 2.0f - 1.0f;
+            }
+        }
+    }
+    Result toResult(juce::int64 ticks, int numBlocks)
+    {
+        const double seconds = juce::Time::highResolutionTicksToSeconds(ticks);
+        const double samples = static_cast<double>(numBlocks) * BLOCK_SIZE;
+        return {seconds * 1.0e9 / samples, SECONDS / seconds};
+    }
+    Result run(BandTopology topology, bool modulate)
+    {
+        Bank bank;
+        bank.setSimdIsa(SimdDispatch::select());
+        bank.prepare(NUM_CHANNELS, BLOCK_SIZE);
+        for (int band = 0; band < NUM_BANDS; ++band)
+        {
+            bank.setTopology(band, topology);
+            bank.setBypassed(band, false);
+        }
+        designAll(bank, topology, 0.0, false);
+        juce::AudioBuffer<float> buffer(NUM_CHANNELS, BLOCK_SIZE);
+        juce::Random random(1);
+        const int numBlocks = static_cast<int>(SECONDS * SAMPLE_RATE / BLOCK_SIZE);
+        juce::int64 ticks = 0;
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillNoise(buffer, random);
+            const auto start = juce::Time::getHighResolutionTicks();
+            {
+                QUASAR_RT_AUDIO_SCOPE;
+                if (modulate)
+                {
+                    const double modulation = std::sin(juce::MathConstants<double>::twoPi * LFO_RATE * block * BLOCK_SIZE / SAMPLE_RATE);
+                    designAll(bank, topology, modulation, topology == BandTopology::Svf);
+                }
+                bank.process(buffer);
+            }
+            ticks += juce::Time::getHighResolutionTicks() - start;
+        }
+        return toResult(ticks, numBlocks);
+    }
+    FilterCascade designCascade(BandTopology topology, int slope)
+    {
+        const auto type = static_cast<int>(FilterType::LowPass);
+        const auto& shape = slopeShapes[slope];
+        FilterCascade cascade;
+        cascade.sections = shape.sections;
+        for (int section = 0; section < shape.sections; ++section)
+        {
+            cascade.stages[static_cast<size_t>(section)] = designBand(topology, type, SAMPLE_RATE, 2000.0f, getSectionQuality(shape, section), 1.0f);
+        }
+        return cascade;
+    }
+    Result runCascade(BandTopology topology, int numActiveBands, int slope)
+    {
+        Bank bank;
+        bank.setSimdIsa(SimdDispatch::select());
+        bank.prepare(NUM_CHANNELS, BLOCK_SIZE);
+        for (int band = 0; band < numActiveBands; ++band)
+        {
+            bank.setTopology(band, topology);
+            bank.setCoefficients(band, designCascade(topology, slope));
+            bank.setBypassed(band, false);
+        }
+        juce::AudioBuffer<float> buffer(NUM_CHANNELS, BLOCK_SIZE);
+        juce::Random random(1);
+        const int numBlocks = static_cast<int>(SECONDS * SAMPLE_RATE / BLOCK_SIZE);
+        juce::int64 ticks = 0;
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillNoise(buffer, random);
+            const auto start = juce::Time::getHighResolutionTicks();
+            {
+                QUASAR_RT_AUDIO_SCOPE;
+                bank.process(buffer);
+            }
+            ticks += juce::Time::getHighResolutionTicks() - start;
+        }
+        return toResult(ticks, numBlocks);
+    }
+    template <int Channels>
+    Result runIsa(SimdIsa isa, BandTopology topology, bool precise, int& groupWidth)
+    {
+        MultiChannelFilterBank<NUM_BANDS, Channels> bank;
+        bank.setSimdIsa(isa);
+        bank.prepare(Channels, BLOCK_SIZE);
+        bank.setDoublePrecision(precise);
+        groupWidth = precise ? bank.getPreciseWidth() : bank.getGroupWidth();
+        for (int band = 0; band < NUM_BANDS; ++band)
+        {
+            const auto type = static_cast<int>(FilterType::Peak);
+            bank.setTopology(band, topology);
+            bank.setCoefficients(band, designBand(topology, type, SAMPLE_RATE, getBandFrequency(band, 0.0), 1.0f, juce::Decibels::decibelsToGain(6.0f)));
+            bank.setBypassed(band, false);
+        }
+        juce::AudioBuffer<float> buffer(Channels, BLOCK_SIZE);
+        juce::Random random(1);
+        const int numBlocks = static_cast<int>(SECONDS * SAMPLE_RATE / BLOCK_SIZE);
+        juce::int64 ticks = 0;
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillNoise(buffer, random);
+            const auto start = juce::Time::getHighResolutionTicks();
+            {
+                QUASAR_RT_AUDIO_SCOPE;
+                bank.process(buffer);
+            }
+            ticks += juce::Time::getHighResolutionTicks() - start;
+        }
+        return toResult(ticks, numBlocks);
+    }
+    void printIsaSweep()
+    {
+        std::printf("\n%-8s %-8s %-14s %8s %14s %14s\n", "isa", "topology", "bank", "width", "ns/sample", "x realtime");
+        for (int i = 0; i < NUM_SIMD_ISAS; ++i)
+        {
+            const auto isa = static_cast<SimdIsa>(i);
+            if (!SimdDispatch::isSupported(isa))
+            {
+                continue;
+            }
+            for (const auto topology : {BandTopology::Biquad, BandTopology::Svf})
+            {
+                const auto* name = topology == BandTopology::Svf ? "SVF" : "Biquad";
+                int width = 0;
+                const auto stereo = runIsa<NUM_CHANNELS>(isa, topology, false, width);
+                std::printf("%-8s %-8s %-14s %8d %14.2f %14.1f\n", SimdDispatch::getName(isa), name, "stereo", width, stereo.nanosecondsPerSample, stereo.realtimeFactor);
+                const auto precise = runIsa<NUM_CHANNELS>(isa, topology, true, width);
+                std::printf("%-8s %-8s %-14s %8d %14.2f %14.1f\n", SimdDispatch::getName(isa), name, "stereo double", width, precise.nanosecondsPerSample, precise.realtimeFactor);
+                const auto surround = runIsa<NUM_SURROUND_CHANNELS>(isa, topology, false, width);
+                std::printf("%-8s %-8s %-14s %8d %14.2f %14.1f\n", SimdDispatch::getName(isa), name, "16 channels", width, surround.nanosecondsPerSample, surround.realtimeFactor);
+            }
+        }
+    }
+    void printAnalyzerKernels()
+    {
+        constexpr int NUM_CALLS = 20000;
+        std::vector<float> spectrum(static_cast<size_t>(BLOCK_SIZE * 16));
+        juce::Random random(1);
+        for (auto& value : spectrum)
+        {
+            value = random.nextFloat();
+        }
+        std::printf("\n%-8s %-24s %14s\n", "isa", "analyzer kernels", "ns/call");
+        for (int i = 0; i < NUM_SIMD_ISAS; ++i)
+        {
+            const auto isa = static_cast<SimdIsa>(i);
+            if (!SimdDispatch::isSupported(isa))
+            {
+                continue;
+            }
+            const auto kernels = SimdDispatch::getAnalyzerKernels(isa);
+            std::vector<float> maxima(spectrum.size());
+            float sink = 0.0f;
+            auto start = juce::Time::getHighResolutionTicks();
+            for (int call = 0; call < NUM_CALLS; ++call)
+            {
+                for (int window = 1; window <= 128; window <<= 1)
+                {
+                    kernels.findMaxima(spectrum.data(), maxima.data(), 256 / window, window);
+                }
+                sink += maxima[0];
+            }
+            const double maximaSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            start = juce::Time::getHighResolutionTicks();
+            for (int call = 0; call < NUM_CALLS; ++call)
+            {
+                sink += kernels.findPeak(spectrum.data() + (call & 7), static_cast<int>(spectrum.size()) - 8);
+            }
+            const double peakSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            std::printf("%-8s %-24s %14.1f\n", SimdDispatch::getName(isa), "spectrum maxima", maximaSeconds * 1.0e9 / NUM_CALLS);
+            std::printf("%-8s %-24s %14.1f\n", SimdDispatch::getName(isa), "block peak", peakSeconds * 1.0e9 / NUM_CALLS);
+            juce::ignoreUnused(sink);
+        }
+    }
+    void printFootprint()
+    {
+        Bank bank;
+        bank.prepare(NUM_CHANNELS, BLOCK_SIZE);
+        std::printf("%-28s %10s\n", "footprint", "bytes");
+        std::printf("%-28s %10zu\n", "filter bank object", sizeof(Bank));
+        std::printf("%-28s %10zu\n", "filter bank hot state", Bank::getHotBytes());
+        std::printf("%-28s %10zu\n", "dynamic eq", sizeof(Dynamics));
+        std::printf("%-28s %10zu\n", "filter bank heap", bank.getHeapBytes());
+        for (int band = 0; band < NUM_BANDS; ++band)
+        {
+            bank.setBypassed(band, false);
+        }
+        std::printf("%-28s %10d\n", "cache lines, 8 stereo bands", bank.getActiveCacheLines());
+        std::printf("\n");
+    }
+    Result runDynamic(BandTopology topology, int numDynamicBands)
+    {
+        Bank bank;
+        Dynamics dynamics;
+        bank.setSimdIsa(SimdDispatch::select());
+        bank.prepare(NUM_CHANNELS, BLOCK_SIZE);
+        dynamics.prepare(SAMPLE_RATE);
+        for (int band = 0; band < NUM_BANDS; ++band)
+        {
+            bank.setTopology(band, topology);
+            bank.setBypassed(band, false);
+            DynamicBandSettings settings;
+            settings.enabled = band < numDynamicBands;
+            settings.topology = topology;
+            settings.freq = getBandFrequency(band, 0.0);
+            settings.gain = 6.0f;
+            settings.threshold = DYNAMIC_THRESHOLD;
+            settings.ratio = DYNAMIC_RATIO;
+            dynamics.configure(band, settings);
+        }
+        designAll(bank, topology, 0.0, false);
+        juce::AudioBuffer<float> buffer(NUM_CHANNELS, BLOCK_SIZE);
+        juce::Random random(1);
+        const int numBlocks = static_cast<int>(SECONDS * SAMPLE_RATE / BLOCK_SIZE);
+        juce::int64 ticks = 0;
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillNoise(buffer, random);
+            const auto start = juce::Time::getHighResolutionTicks();
+            {
+                QUASAR_RT_AUDIO_SCOPE;
+                const auto* left = buffer.getReadPointer(0);
+                const auto* right = buffer.getReadPointer(1);
+                for (int offset = 0; offset < BLOCK_SIZE; offset += Dynamics::UPDATE_INTERVAL)
+                {
+                    const int chunk = juce::jmin(Dynamics::UPDATE_INTERVAL, BLOCK_SIZE - offset);
+                    if (dynamics.isActive())
+                    {
+                        dynamics.process(left + offset, right + offset, chunk);
+                        dynamics.update([&bank](int band, const BiquadCoefficients& coefficients)
+                        {
+                            bank.glideTo(band, coefficients, Dynamics::UPDATE_INTERVAL);
+                        });
+                    }
+                    bank.process(buffer, offset, chunk);
+                }
+            }
+            ticks += juce::Time::getHighResolutionTicks() - start;
+        }
+        return toResult(ticks, numBlocks);
+    }
+}
+int main(int argc, char* argv[])
+{
+    juce::ignoreUnused(argc, argv);
+    printFootprint();
+    std::printf("%-8s %-12s %14s %14s\n", "topology", "mode", "ns/sample", "x realtime");
+    for (const auto topology : {BandTopology::Biquad, BandTopology::Svf})
+    {
+        for (const bool modulate : {false, true})
+        {
+            const auto result = run(topology, modulate);
+            std::printf("%-8s %-12s %14.2f %14.1f\n", topology == BandTopology::Svf ? "SVF" : "Biquad", modulate ? "modulated" : "steady", result.nanosecondsPerSample, result.realtimeFactor);
+        }
+    }
+    std::printf("\n%-8s %-12s %14s %14s %14s\n", "topology", "dynamic", "ns/sample", "x realtime", "ns/band");
+    for (const auto topology : {BandTopology::Biquad, BandTopology::Svf})
+    {
+        const auto baseline = runDynamic(topology, 0);
+        for (const int numDynamicBands : {0, 1, 4, NUM_BANDS})
+        {
+            const auto result = numDynamicBands == 0 ? baseline : runDynamic(topology, numDynamicBands);
+            const double perBand = numDynamicBands == 0 ? 0.0 : (result.nanosecondsPerSample - baseline.nanosecondsPerSample) / numDynamicBands;
+            std::printf("%-8s %-12d %14.2f %14.1f %14.2f\n", topology == BandTopology::Svf ? "SVF" : "Biquad", numDynamicBands, result.nanosecondsPerSample, result.realtimeFactor, perBand);
+        }
+    }
+    constexpr int SLOPE_48 = 4;
+    std::printf("\n%-8s %-24s %14s %14s\n", "topology", "48 dB/oct lowpass", "ns/sample", "x realtime");
+    for (const auto topology : {BandTopology::Biquad, BandTopology::Svf})
+    {
+        const auto separate = runCascade(topology, SLOPE_48, 0);
+        const auto cascaded = runCascade(topology, 1, SLOPE_48);
+        const auto* name = topology == BandTopology::Svf ? "SVF" : "Biquad";
+        std::printf("%-8s %-24s %14.2f %14.1f\n", name, "4 bands x 12 dB/oct", separate.nanosecondsPerSample, separate.realtimeFactor);
+        std::printf("%-8s %-24s %14.2f %14.1f\n", name, "1 band x 4 sections", cascaded.nanosecondsPerSample, cascaded.realtimeFactor);
+    }
+    printIsaSweep();
+    printAnalyzerKernels();
+#if QUASAR_RT_CHECK
+    const int violations = quasar::rt::getViolationCount();
+    std::printf("real-time violations: %d\n", violations);
+    return violations == 0 ? 0 : 1;
+#else
+    return 0;
+#endif
+}
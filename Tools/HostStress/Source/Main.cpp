@@ -0,0 +1,494 @@
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+    constexpr int DEFAULT_INSTANCES = 200;
+    constexpr int DEFAULT_CHAIN = 4;
+    constexpr int DEFAULT_BLOCK_SIZE = 128;
+    constexpr double DEFAULT_SAMPLE_RATE = 48000.0;
+    constexpr double DEFAULT_SECONDS = 10.0;
+    constexpr int DEFAULT_LANES = 3;
+    constexpr int NUM_CHANNELS = 2;
+    constexpr int NOISE_LENGTH = 1 << 16;
+    constexpr float NOISE_LEVEL = 0.25f;
+    constexpr float LANE_STEP = 0.01f;
+    constexpr double PERCENTILE = 0.99;
+    constexpr int WAIT_INTERVAL = 20;
+    struct Options
+    {
+        int numInstances = DEFAULT_INSTANCES;
+        int chainLength = DEFAULT_CHAIN;
+        int blockSize = DEFAULT_BLOCK_SIZE;
+        double sampleRate = DEFAULT_SAMPLE_RATE;
+        double seconds = DEFAULT_SECONDS;
+        int numLanes = DEFAULT_LANES;
+        int numThreads = 0;
+        int numEditors = 0;
+        bool scaling = false;
+        bool freewheel = false;
+        bool showEditors = false;
+    };
+    bool parseOptions(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const juce::String arg(argv[i]);
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--instances" && hasValue)
+            {
+                options.numInstances = juce::String(argv[++i]).getIntValue();
+            }
+            else if (arg == "--chain" && hasValue)
+            {
+                options.chainLength = juce::String(argv[++i]).getIntValue();
+            }
+            else if (arg == "--block" && hasValue)
+            {
+                options.blockSize = juce::String(argv[++i]).getIntValue();
+            }
+            else if (arg == "--rate" && hasValue)
+            {
+                options.sampleRate = juce::String(argv[++i]).getDoubleValue();
+            }
+            else if (arg == "--seconds" && hasValue)
+            {
+                options.seconds = juce::String(argv[++i]).getDoubleValue();
+            }
+            else if (arg == "--lanes" && hasValue)
+            {
+                options.numLanes = juce::String(argv[++i]).getIntValue();
+            }
+            else if (arg == "--threads" && hasValue)
+            {
+                options.numThreads = juce::String(argv[++i]).getIntValue();
+            }
+            else if (arg == "--editors" && hasValue)
+            {
+                options.numEditors = juce::String(argv[++i]).getIntValue();
+            }
+            else if (arg == "--scaling")
+            {
+                options.scaling = true;
+            }
+            else if (arg == "--freewheel")
+            {
+                options.freewheel = true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        if (options.numThreads <= 0)
+        {
+            options.numThreads = juce::SystemStats::getNumCpus();
+        }
+        options.numEditors = juce::jmin(options.numEditors, options.numInstances);
+        return options.numInstances > 0 && options.chainLength > 0 && options.blockSize > 0 && options.sampleRate > 0.0 && options.seconds > 0.0 && options.numLanes >= 0 && options.numEditors >= 0;
+    }
+    struct Result
+    {
+        int numCycles = 0;
+        int misses = 0;
+        double meanCycle = 0.0;
+        double percentileCycle = 0.0;
+        double worstCycle = 0.0;
+        double meanBlock = 0.0;
+        double worstBlock = 0.0;
+        double load = 0.0;
+        int violations = 0;
+        double meanConstruct = 0.0;
+        double worstConstruct = 0.0;
+        double meanFirstPaint = 0.0;
+        double worstFirstPaint = 0.0;
+    };
+    struct Lane
+    {
+        juce::AudioProcessorParameter* parameter = nullptr;
+        float value = 0.0f;
+    };
+    struct Instance
+    {
+        std::unique_ptr<QuasarEQAudioProcessor> processor;
+        std::vector<Lane> lanes;
+        juce::int64 blockTicks = 0;
+        juce::int64 worstBlockTicks = 0;
+        juce::int64 numBlocks = 0;
+    };
+    struct Track
+    {
+        std::vector<Instance*> chain;
+        juce::AudioBuffer<float> buffer;
+        juce::Random random;
+        int noisePosition = 0;
+    };
+    class Session
+    {
+    public:
+        explicit Session(const Options& o): options(o), periodTicks(juce::Time::secondsToHighResolutionTicks(o.blockSize / o.sampleRate))
+        {
+            juce::Random random(1);
+            noise.resize(NOISE_LENGTH + static_cast<size_t>(options.blockSize));
+            for (auto& sample : noise)
+            {
+                sample = (random.nextFloat() * 2.0f - 1.0f) * NOISE_LEVEL;
+            }
+            for (int i = 0; i < options.numInstances; ++i)
+            {
+                instances.push_back(createInstance(random));
+            }
+            const int numTracks = (options.numInstances + options.chainLength - 1) / options.chainLength;
+            tracks.resize(static_cast<size_t>(numTracks));
+            for (int i = 0; i < options.numInstances; ++i)
+            {
+                tracks[static_cast<size_t>(i / options.chainLength)].chain.push_back(&instances[static_cast<size_t>(i)]);
+            }
+            for (int t = 0; t < numTracks; ++t)
+            {
+                auto& track = tracks[static_cast<size_t>(t)];
+                track.buffer.setSize(NUM_CHANNELS, options.blockSize);
+                track.random.setSeed(t + 1);
+                track.noisePosition = random.nextInt(NOISE_LENGTH);
+            }
+            cycleTicks.reserve(static_cast<size_t>(getNumCycles()));
+        }
+        int getNumTracks() const
+        {
+            return static_cast<int>(tracks.size());
+        }
+        double getPeriodMilliseconds() const
+        {
+            return options.blockSize * 1000.0 / options.sampleRate;
+        }
+        Result run(int numThreads, int numEditors)
+        {
+            resetStatistics();
+            std::vector<std::unique_ptr<juce::AudioProcessorEditor>> editors;
+            std::vector<EditorTiming> timings;
+            {
+                const juce::MessageManagerLock lock;
+                for (int i = 0; i < numEditors; ++i)
+                {
+                    timings.emplace_back();
+                    editors.push_back(openEditor(*instances[static_cast<size_t>(i)].processor, timings.back()));
+                }
+            }
+            juce::OwnedArray<Worker> workers;
+            for (int i = 1; i < numThreads; ++i)
+            {
+                workers.add(new Worker(*this, i));
+            }
+            for (auto* worker : workers)
+            {
+                if (!worker->startRealtimeThread(juce::Thread::RealtimeOptions().withApproximateAudioProcessingTime(options.blockSize, options.sampleRate)))
+                {
+                    worker->startThread(juce::Thread::Priority::highest);
+                }
+            }
+            const int violationsBefore = getViolationCount();
+            const int numCycles = getNumCycles();
+            auto due = juce::Time::getHighResolutionTicks();
+            for (int cycle = 0; cycle < numCycles; ++cycle)
+            {
+                if (!options.freewheel)
+                {
+                    waitUntil(due);
+                }
+                const auto cycleStart = juce::Time::getHighResolutionTicks();
+                remaining.store(getNumTracks(), std::memory_order_release);
+                nextTrack.store(0, std::memory_order_release);
+                for (auto* worker : workers)
+                {
+                    worker->wake.signal();
+                }
+                processTracks();
+                finished.wait();
+                cycleTicks.push_back(cycleEnd.load(std::memory_order_acquire) - cycleStart);
+                due = juce::jmax(due + periodTicks, juce::Time::getHighResolutionTicks());
+            }
+            for (auto* worker : workers)
+            {
+                worker->signalThreadShouldExit();
+                worker->wake.signal();
+            }
+            for (auto* worker : workers)
+            {
+                worker->stopThread(-1);
+            }
+            {
+                const juce::MessageManagerLock lock;
+                editors.clear();
+            }
+            auto result = summarise();
+            summariseEditors(timings, result);
+            result.violations = getViolationCount() - violationsBefore;
+            return result;
+        }
+    private:
+        class Worker: public juce::Thread
+        {
+        public:
+            Worker(Session& s, int i): juce::Thread("Host Worker " + juce::String(i)), session(s)
+            {
+            }
+            void run() override
+            {
+                while (!threadShouldExit())
+                {
+                    if (wake.wait(WAIT_INTERVAL))
+                    {
+                        session.processTracks();
+                    }
+                }
+            }
+            juce::WaitableEvent wake;
+        private:
+            Session& session;
+        };
+        const Options options;
+        const juce::int64 periodTicks;
+        std::vector<float> noise;
+        std::vector<Instance> instances;
+        std::vector<Track> tracks;
+        std::vector<juce::int64> cycleTicks;
+        std::atomic<int> nextTrack {0};
+        std::atomic<int> remaining {0};
+        std::atomic<juce::int64> cycleEnd {0};
+        juce::WaitableEvent finished;
+        int getNumCycles() const
+        {
+            return juce::jmax(1, static_cast<int>(options.seconds * options.sampleRate / options.blockSize));
+        }
+        static int getViolationCount()
+        {
+#if QUASAR_RT_CHECK
+            return quasar::rt::getViolationCount();
+#else
+            return 0;
+#endif
+        }
+        Instance createInstance(juce::Random& random) const
+        {
+            Instance instance;
+            instance.processor = std::make_unique<QuasarEQAudioProcessor>();
+            auto& processor = *instance.processor;
+            auto& apvts = processor.apvts;
+            processor.setPlayConfigDetails(NUM_CHANNELS, NUM_CHANNELS, options.sampleRate, options.blockSize);
+            for (int band = 0; band < NUM_BANDS; ++band)
+            {
+                const juce::String index(band + 1);
+                auto* freq = apvts.getParameter(ID_PREFIX_FREQ + index);
+                freq->setValueNotifyingHost(freq->convertTo0to1(static_cast<float>(60.0 * std::pow(2.0, band * 1.2))));
+                apvts.getParameter(ID_PREFIX_BYPASS + index)->setValueNotifyingHost(0.0f);
+            }
+            const juce::StringArray automatable {ID_PREFIX_FREQ, ID_PREFIX_GAIN, ID_PREFIX_Q};
+            for (int i = 0; i < options.numLanes; ++i)
+            {
+                auto* parameter = apvts.getParameter(automatable[i % automatable.size()] + juce::String(random.nextInt(NUM_BANDS) + 1));
+                instance.lanes.push_back({parameter, parameter->getValue()});
+            }
+            processor.prepareToPlay(options.sampleRate, options.blockSize);
+            return instance;
+        }
+        struct EditorTiming
+        {
+            juce::int64 constructTicks = 0;
+            juce::int64 firstPaintTicks = 0;
+        };
+        std::unique_ptr<juce::AudioProcessorEditor> openEditor(QuasarEQAudioProcessor& processor, EditorTiming& timing) const
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            std::unique_ptr<juce::AudioProcessorEditor> editor(processor.createEditorIfNeeded());
+            const auto constructed = juce::Time::getHighResolutionTicks();
+            editor->createComponentSnapshot(editor->getLocalBounds());
+            timing.constructTicks = constructed - start;
+            timing.firstPaintTicks = juce::Time::getHighResolutionTicks() - constructed;
+            if (options.showEditors)
+            {
+                editor->addToDesktop(juce::ComponentPeer::windowHasTitleBar);
+                editor->setVisible(true);
+            }
+            return editor;
+        }
+        static void summariseEditors(const std::vector<EditorTiming>& timings, Result& result)
+        {
+            if (timings.empty())
+            {
+                return;
+            }
+            const auto toMilliseconds = [](juce::int64 ticks) { return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e3; };
+            for (const auto& timing : timings)
+            {
+                result.meanConstruct += toMilliseconds(timing.constructTicks);
+                result.worstConstruct = juce::jmax(result.worstConstruct, toMilliseconds(timing.constructTicks));
+                result.meanFirstPaint += toMilliseconds(timing.firstPaintTicks);
+                result.worstFirstPaint = juce::jmax(result.worstFirstPaint, toMilliseconds(timing.firstPaintTicks));
+            }
+            result.meanConstruct /= static_cast<double>(timings.size());
+            result.meanFirstPaint /= static_cast<double>(timings.size());
+        }
+        void waitUntil(juce::int64 due) const
+        {
+            const auto marginTicks = juce::Time::secondsToHighResolutionTicks(0.002);
+            for (auto now = juce::Time::getHighResolutionTicks(); now < due; now = juce::Time::getHighResolutionTicks())
+            {
+                if (due - now > marginTicks)
+                {
+                    juce::Thread::sleep(1);
+                }
+                else
+                {
+                    juce::Thread::yield();
+                }
+            }
+        }
+        void processTracks()
+        {
+            for (;;)
+            {
+                const int t = nextTrack.fetch_add(1, std::memory_order_acq_rel);
+                if (t >= getNumTracks())
+                {
+                    return;
+                }
+                processTrack(tracks[static_cast<size_t>(t)]);
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    cycleEnd.store(juce::Time::getHighResolutionTicks(), std::memory_order_release);
+                    finished.signal();
+                }
+            }
+        }
+        void processTrack(Track& track)
+        {
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+            {
+                const auto position = static_cast<size_t>((track.noisePosition + ch * NOISE_LENGTH / NUM_CHANNELS) % NOISE_LENGTH);
+                track.buffer.copyFrom(ch, 0, noise.data() + position, options.blockSize);
+            }
+            track.noisePosition = (track.noisePosition + options.blockSize) % NOISE_LENGTH;
+            juce::MidiBuffer midi;
+            for (auto* instance : track.chain)
+            {
+                for (auto& lane : instance->lanes)
+                {
+                    lane.value = juce::jlimit(0.0f, 1.0f, lane.value + (track.random.nextFloat() * 2.0f - 1.0f) * LANE_STEP);
+                    lane.parameter->setValue(lane.value);
+                    lane.parameter->sendValueChangedMessageToListeners(lane.value);
+                }
+                const auto start = juce::Time::getHighResolutionTicks();
+                instance->processor->processBlock(track.buffer, midi);
+                const auto ticks = juce::Time::getHighResolutionTicks() - start;
+                instance->blockTicks += ticks;
+                instance->worstBlockTicks = juce::jmax(instance->worstBlockTicks, ticks);
+                ++instance->numBlocks;
+            }
+        }
+        void resetStatistics()
+        {
+            cycleTicks.clear();
+            for (auto& instance : instances)
+            {
+                instance.blockTicks = 0;
+                instance.worstBlockTicks = 0;
+                instance.numBlocks = 0;
+            }
+        }
+        Result summarise() const
+        {
+            Result result;
+            result.numCycles = static_cast<int>(cycleTicks.size());
+            auto sorted = cycleTicks;
+            std::sort(sorted.begin(), sorted.end());
+            juce::int64 total = 0;
+            for (const auto ticks : sorted)
+            {
+                total += ticks;
+                result.misses += ticks > periodTicks ? 1 : 0;
+            }
+            const auto toMicroseconds = [](juce::int64 ticks) { return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6; };
+            result.meanCycle = toMicroseconds(total) / juce::jmax(1, result.numCycles);
+            result.percentileCycle = toMicroseconds(sorted[static_cast<size_t>(PERCENTILE * (sorted.size() - 1))]);
+            result.worstCycle = toMicroseconds(sorted.back());
+            result.load = result.meanCycle / (getPeriodMilliseconds() * 1000.0);
+            juce::int64 blockTicks = 0;
+            juce::int64 numBlocks = 0;
+            for (const auto& instance : instances)
+            {
+                blockTicks += instance.blockTicks;
+                numBlocks += instance.numBlocks;
+                result.worstBlock = juce::jmax(result.worstBlock, toMicroseconds(instance.worstBlockTicks));
+            }
+            result.meanBlock = toMicroseconds(blockTicks) / static_cast<double>(juce::jmax(static_cast<juce::int64>(1), numBlocks));
+            return result;
+        }
+    };
+    void printResult(int numThreads, int numEditors, const Result& result)
+    {
+        std::printf("%7d %7d %8d %10.1f %10.1f %10.1f %10.1f %10.1f %8d %7.1f%% %6d\n", numThreads, numEditors, result.numCycles, result.meanCycle, result.percentileCycle, result.worstCycle, result.meanBlock, result.worstBlock, result.misses, result.load * 100.0, result.violations);
+    }
+    class Host: public juce::Thread
+    {
+    public:
+        Host(Session& s, const Options& o): juce::Thread("Host"), session(s), options(o)
+        {
+        }
+        void run() override
+        {
+            juce::SharedResourcePointer<AnalyzerScheduler> analyzerScheduler;
+            std::printf("%d instances on %d tracks of %d, %d samples at %.0f Hz (%.2f ms deadline), %d automation lanes each, %s kernels, %d analyzer workers%s\n", options.numInstances, session.getNumTracks(), options.chainLength, options.blockSize, options.sampleRate, session.getPeriodMilliseconds(), options.numLanes, SimdDispatch::getName(SimdDispatch::select()), analyzerScheduler->getNumWorkers(), options.freewheel ? ", freewheeling" : "");
+            if (options.numEditors > 0)
+            {
+                std::printf("editor rows open %d plugin editors %s; rows without editors run no analysis\n", options.numEditors, options.showEditors ? "on screen" : "off screen");
+            }
+            std::printf("%7s %7s %8s %10s %10s %10s %10s %10s %8s %8s %6s\n", "threads", "editors", "cycles", "mean us", "p99 us", "worst us", "block us", "worst blk", "misses", "load", "rt");
+            std::vector<int> threadCounts;
+            if (options.scaling)
+            {
+                for (int n = 1; n < options.numThreads; n <<= 1)
+                {
+                    threadCounts.push_back(n);
+                }
+            }
+            threadCounts.push_back(options.numThreads);
+            int violations = 0;
+            for (const int numThreads : threadCounts)
+            {
+                const auto result = session.run(numThreads, 0);
+                printResult(numThreads, 0, result);
+                violations += result.violations;
+                if (options.numEditors > 0)
+                {
+                    const auto withEditors = session.run(numThreads, options.numEditors);
+                    printResult(numThreads, options.numEditors, withEditors);
+                    std::printf("%7s editor open: construct %.2f ms (worst %.2f ms), first paint %.2f ms (worst %.2f ms)\n", "", withEditors.meanConstruct, withEditors.worstConstruct, withEditors.meanFirstPaint, withEditors.worstFirstPaint);
+                    violations += withEditors.violations;
+                }
+            }
+            exitCode = violations == 0 ? 0 : 1;
+            juce::MessageManager::getInstance()->stopDispatchLoop();
+        }
+        int exitCode = 1;
+    private:
+        Session& session;
+        const Options& options;
+    };
+}
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::printf("usage: HostStress [--instances n] [--chain n] [--block samples] [--rate Hz] [--seconds s] [--lanes n] [--threads n] [--scaling] [--editors n] [--freewheel]\n");
+        return 2;
+    }
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    options.showEditors = juce::Desktop::getInstance().getDisplays().getPrimaryDisplay() != nullptr;
+    Session session(options);
+    Host host(session, options);
+    host.startThread();
+    juce::MessageManager::getInstance()->runDispatchLoop();
+    host.stopThread(-1);
+    return host.exitCode;
+}
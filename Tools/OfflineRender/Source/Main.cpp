@@ -0,0 +1,180 @@
+#include <JuceHeader.h>
+#include "../../../Source/QOfflineRenderer.h"
+
+namespace
+{
+    constexpr int OUTPUT_BITS = 32;
+    struct Options
+    {
+        juce::File input;
+        juce::File output;
+        juce::File state;
+        juce::File reference;
+        int numThreads = 0;
+        bool verify = false;
+    };
+    bool parseOptions(int argc, char* argv[], Options& options)
+    {
+        juce::StringArray positional;
+        for (int i = 1; i < argc; ++i)
+        {
+            const juce::String arg(argv[i]);
+            if (arg == "--verify")
+            {
+                options.verify = true;
+            }
+            else if (arg == "--state" && i + 1 < argc)
+            {
+                options.state = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+            }
+            else if (arg == "--match" && i + 1 < argc)
+            {
+                options.reference = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                options.numThreads = juce::String(argv[++i]).getIntValue();
+            }
+            else
+            {
+                positional.add(arg);
+            }
+        }
+        if (positional.size() != 2)
+        {
+            return false;
+        }
+        options.input = juce::File::getCurrentWorkingDirectory().getChildFile(positional[0]);
+        options.output = juce::File::getCurrentWorkingDirectory().getChildFile(positional[1]);
+        return true;
+    }
+    juce::MemoryBlock loadState(const juce::File& file)
+    {
+        juce::MemoryBlock state;
+        if (file != juce::File() && file.loadFileAsData(state))
+        {
+            return state;
+        }
+        QuasarEQAudioProcessor defaults;
+        defaults.getStateInformation(state);
+        return state;
+    }
+    bool matchReference(juce::AudioFormatManager& formats, const juce::File& file, juce::AudioFormatReader& input, juce::MemoryBlock& state)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reference(formats.createReaderFor(file));
+        if (reference == nullptr)
+        {
+            std::printf("cannot read reference %s\n", file.getFullPathName().toRawUTF8());
+            return false;
+        }
+        LongTermSpectrum referenceSpectrum;
+        LongTermSpectrum targetSpectrum;
+        referenceSpectrum.analyse(*reference);
+        targetSpectrum.analyse(input);
+        const auto start = juce::Time::getHighResolutionTicks();
+        const auto matched = QuasarEQAudioProcessor::fitSpectrum(referenceSpectrum.getDecibels(), targetSpectrum.getDecibels(), input.sampleRate);
+        const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        QuasarEQAudioProcessor processor;
+        processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+        processor.applyMatchedBands(matched);
+        state.reset();
+        processor.getStateInformation(state);
+        std::printf("matched %lld + %lld frames in %.1f ms\n", static_cast<long long>(referenceSpectrum.getNumFrames()), static_cast<long long>(targetSpectrum.getNumFrames()), seconds * 1000.0);
+        for (size_t band = 0; band < matched.size(); ++band)
+        {
+            const auto& b = matched[band];
+            if (b.enabled)
+            {
+                std::printf("  band %d: %s %.1f Hz %+.2f dB Q %.2f\n", static_cast<int>(band + 1), filterTags[b.type].toRawUTF8(), b.freq, b.gain, b.q);
+            }
+        }
+        return true;
+    }
+    OfflineRenderer::Sink appendTo(juce::AudioBuffer<float>& destination, juce::int64& position)
+    {
+        return [&destination, &position](const juce::AudioBuffer<float>& source, int numSamples)
+        {
+            for (int ch = 0; ch < destination.getNumChannels(); ++ch)
+            {
+                destination.copyFrom(ch, static_cast<int>(position), source, ch, 0, numSamples);
+            }
+            position += numSamples;
+            return true;
+        };
+    }
+    int verify(OfflineRenderer& renderer, juce::AudioFormatReader& reader)
+    {
+        const auto length = static_cast<int>(reader.lengthInSamples);
+        const auto numChannels = static_cast<int>(reader.numChannels);
+        juce::AudioBuffer<float> parallel(numChannels, length);
+        juce::AudioBuffer<float> serial(numChannels, length);
+        juce::int64 parallelPosition = 0;
+        juce::int64 serialPosition = 0;
+        renderer.render(reader, appendTo(parallel, parallelPosition));
+        renderer.renderSerial(reader, appendTo(serial, serialPosition));
+        const double null = OfflineRenderer::getNullDecibels(parallel, serial);
+        std::printf("null test: %.1f dBFS (limit %.1f dBFS)\n", null, OfflineRenderer::NULL_THRESHOLD_DB);
+        return null < OfflineRenderer::NULL_THRESHOLD_DB ? 0 : 1;
+    }
+}
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::printf("usage: OfflineRender <input> <output.wav> [--state file] [--match reference] [--threads n] [--verify]\n");
+        return 2;
+    }
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(options.input));
+    if (reader == nullptr || reader->numChannels < 1 || reader->numChannels > 2)
+    {
+        std::printf("cannot read mono or stereo audio from %s\n", options.input.getFullPathName().toRawUTF8());
+        return 1;
+    }
+    auto state = loadState(options.state);
+    if (options.reference != juce::File() && !matchReference(formats, options.reference, *reader, state))
+    {
+        return 1;
+    }
+    OfflineRenderer renderer(state, reader->sampleRate, static_cast<int>(reader->numChannels), options.numThreads);
+    if (!renderer.isParallelSafe())
+    {
+        std::printf("dynamic bands active: rendering serially\n");
+    }
+    options.output.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(options.output.createOutputStream());
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(stream == nullptr ? nullptr : wav.createWriterFor(stream.get(), reader->sampleRate, reader->numChannels, OUTPUT_BITS, {}, 0));
+    if (writer == nullptr)
+    {
+        std::printf("cannot write %s\n", options.output.getFullPathName().toRawUTF8());
+        return 1;
+    }
+    stream.release();
+    const auto start = juce::Time::getHighResolutionTicks();
+    const bool rendered = renderer.render(*reader, [&writer](const juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        return writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+    });
+    writer.reset();
+    const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+    const double duration = static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
+    std::printf("%s: %.2f s in %.2f s (%.1fx realtime, %d threads, %s kernels, %lld samples pre-roll)\n", rendered ? "rendered" : "failed", duration, seconds, duration / seconds, renderer.getNumThreads(), SimdDispatch::getName(SimdDispatch::select()), static_cast<long long>(renderer.getPreRollSamples()));
+    if (!rendered)
+    {
+        return 1;
+    }
+    const int result = options.verify ? verify(renderer, *reader) : 0;
+#if QUASAR_RT_CHECK
+    const int violations = quasar::rt::getViolationCount();
+    std::printf("real-time violations: %d\n", violations);
+    if (violations > 0)
+    {
+        return 1;
+    }
+#endif
+    return result;
+}
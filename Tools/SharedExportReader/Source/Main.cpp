@@ -0,0 +1,227 @@
+#include <JuceHeader.h>
+#include "../../../Source/QSharedExport.h"
+
+namespace
+{
+    constexpr int DEFAULT_WRITERS = 128;
+    constexpr double DEFAULT_SECONDS = 5.0;
+    constexpr double DEFAULT_RATE = 100.0;
+    constexpr double BENCH_SAMPLE_RATE = 48000.0;
+    constexpr int BENCH_FFT_SIZE = 4096;
+    struct Options
+    {
+        int numWriters = 0;
+        double seconds = DEFAULT_SECONDS;
+        double rate = DEFAULT_RATE;
+        int numPolls = 1;
+        int interval = 100;
+    };
+    bool parseOptions(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const juce::String arg(argv[i]);
+            if (arg == "--bench")
+            {
+                options.numWriters = i + 1 < argc && juce::String(argv[i + 1]).containsOnly("0123456789") ? juce::String(argv[++i]).getIntValue() : DEFAULT_WRITERS;
+            }
+            else if (arg == "--seconds" && i + 1 < argc)
+            {
+                options.seconds = juce::String(argv[++i]).getDoubleValue();
+            }
+            else if (arg == "--rate" && i + 1 < argc)
+            {
+                options.rate = juce::String(argv[++i]).getDoubleValue();
+            }
+            else if (arg == "--watch" && i + 1 < argc)
+            {
+                options.numPolls = juce::String(argv[++i]).getIntValue();
+            }
+            else if (arg == "--interval" && i + 1 < argc)
+            {
+                options.interval = juce::String(argv[++i]).getIntValue();
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.numPolls > 0 && options.interval > 0 && options.seconds > 0.0 && options.rate >= 0.0;
+    }
+    void printFrame(const SharedSpectrumReader& reader, const SharedExportLayout::Frame& frame)
+    {
+        int loudest = 0;
+        for (int i = 1; i < SharedExportLayout::NUM_POINTS; ++i)
+        {
+            if (frame.spectrum[i] > frame.spectrum[loudest])
+            {
+                loudest = i;
+            }
+        }
+        std::printf("%-28s pid %-7d frame %-10llu %6.0f Hz  L %6.1f dB  R %6.1f dB  peak %6.1f dB at %.0f Hz\n", reader.getName().toRawUTF8(), reader.getOwnerPid(), static_cast<unsigned long long>(frame.index), frame.sampleRate, frame.leftDB, frame.rightDB, frame.spectrum[loudest], reader.getFrequency(loudest, frame.sampleRate));
+    }
+    int watch(const Options& options)
+    {
+        for (int poll = 0; poll < options.numPolls; ++poll)
+        {
+            const auto names = SharedSpectrumReader::findInstances();
+            if (names.isEmpty())
+            {
+                std::printf("no exporting instances (set QUASAR_SHARED_EXPORT=1 in the host environment)\n");
+            }
+            for (const auto& name : names)
+            {
+                SharedSpectrumReader reader;
+                SharedExportLayout::Frame frame;
+                if (reader.open(name) && reader.readLatest(frame))
+                {
+                    printFrame(reader, frame);
+                }
+            }
+            if (poll + 1 < options.numPolls)
+            {
+                std::printf("\n");
+                juce::Thread::sleep(options.interval);
+            }
+        }
+        return 0;
+    }
+    class Writer: public juce::Thread
+    {
+    public:
+        Writer(int i, const std::vector<int>& binIndices, double rate): juce::Thread("Export Writer " + juce::String(i + 1)), period(rate > 0.0 ? juce::Time::secondsToHighResolutionTicks(1.0 / rate) : 0)
+        {
+            opened = destination.open(binIndices, BENCH_FFT_SIZE);
+        }
+        void run() override
+        {
+            std::vector<float> spectrum(SharedExportLayout::NUM_POINTS);
+            auto due = juce::Time::getHighResolutionTicks();
+            while (!threadShouldExit())
+            {
+                const auto value = static_cast<float>(published);
+                std::fill(spectrum.begin(), spectrum.end(), value);
+                const auto start = juce::Time::getHighResolutionTicks();
+                destination.publish(spectrum.data(), spectrum.data(), value, value, BENCH_SAMPLE_RATE);
+                publishTicks += juce::Time::getHighResolutionTicks() - start;
+                ++published;
+                if (period > 0)
+                {
+                    due += period;
+                    const auto remaining = due - juce::Time::getHighResolutionTicks();
+                    if (remaining > 0)
+                    {
+                        juce::Thread::sleep(static_cast<int>(juce::Time::highResolutionTicksToSeconds(remaining) * 1000.0));
+                    }
+                }
+            }
+        }
+        SharedSpectrumExport destination;
+        const juce::int64 period;
+        bool opened = false;
+        juce::uint64 published = 0;
+        juce::int64 publishTicks = 0;
+    };
+    bool isConsistent(const SharedExportLayout::Frame& frame)
+    {
+        const auto expected = static_cast<float>(frame.index);
+        for (int i = 0; i < SharedExportLayout::NUM_POINTS; ++i)
+        {
+            if (frame.spectrum[i] != expected || frame.peakHold[i] != expected)
+            {
+                return false;
+            }
+        }
+        return frame.leftDB == expected && frame.rightDB == expected;
+    }
+    int bench(const Options& options)
+    {
+        std::vector<int> binIndices(SharedExportLayout::NUM_POINTS);
+        for (int i = 0; i < SharedExportLayout::NUM_POINTS; ++i)
+        {
+            binIndices[static_cast<size_t>(i)] = i;
+        }
+        juce::OwnedArray<Writer> writers;
+        for (int i = 0; i < options.numWriters; ++i)
+        {
+            auto* writer = writers.add(new Writer(i, binIndices, options.rate));
+            if (!writer->opened)
+            {
+                std::printf("cannot open shared export %d of %d\n", i + 1, options.numWriters);
+                return 1;
+            }
+        }
+        juce::OwnedArray<SharedSpectrumReader> readers;
+        for (const auto& name : SharedSpectrumReader::findInstances())
+        {
+            auto reader = std::make_unique<SharedSpectrumReader>();
+            if (reader->open(name) && reader->getOwnerPid() == SharedSpectrumExport::getCurrentPid())
+            {
+                readers.add(reader.release());
+            }
+        }
+        if (readers.size() != options.numWriters)
+        {
+            std::printf("directory lists %d of %d writers\n", readers.size(), options.numWriters);
+            return 1;
+        }
+        for (auto* writer : writers)
+        {
+            writer->startThread(juce::Thread::Priority::normal);
+        }
+        juce::int64 reads = 0;
+        juce::int64 misses = 0;
+        juce::int64 torn = 0;
+        int retries = 0;
+        SharedExportLayout::Frame frame;
+        const auto start = juce::Time::getHighResolutionTicks();
+        const auto duration = juce::Time::secondsToHighResolutionTicks(options.seconds);
+        while (juce::Time::getHighResolutionTicks() - start < duration)
+        {
+            for (auto* reader : readers)
+            {
+                if (!reader->readLatest(frame, &retries))
+                {
+                    ++misses;
+                    continue;
+                }
+                ++reads;
+                torn += isConsistent(frame) ? 0 : 1;
+            }
+        }
+        for (auto* writer : writers)
+        {
+            writer->signalThreadShouldExit();
+        }
+        for (auto* writer : writers)
+        {
+            writer->stopThread(-1);
+        }
+        const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        juce::uint64 published = 0;
+        juce::int64 publishTicks = 0;
+        for (auto* writer : writers)
+        {
+            published += writer->published;
+            publishTicks += writer->publishTicks;
+        }
+        const double frameBytes = static_cast<double>(sizeof(SharedExportLayout::Frame));
+        std::printf("%d writers at %.0f frames/s (0 = unthrottled), %.1f s, %zu bytes per frame\n", options.numWriters, options.rate, seconds, sizeof(SharedExportLayout::Frame));
+        std::printf("published %14.0f frames/s %10.1f MB/s\n", static_cast<double>(published) / seconds, static_cast<double>(published) * frameBytes / seconds / 1.0e6);
+        std::printf("read      %14.0f frames/s %10.1f MB/s\n", static_cast<double>(reads) / seconds, static_cast<double>(reads) * frameBytes / seconds / 1.0e6);
+        std::printf("publish   %14.1f ns/frame\n", juce::Time::highResolutionTicksToSeconds(publishTicks) * 1.0e9 / static_cast<double>(juce::jmax(static_cast<juce::uint64>(1), published)));
+        std::printf("retries %d, missed reads %lld, torn frames %lld\n", retries, static_cast<long long>(misses), static_cast<long long>(torn));
+        return torn == 0 ? 0 : 1;
+    }
+}
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::printf("usage: SharedExportReader [--watch polls] [--interval ms] | --bench [writers] [--rate frames/s] [--seconds s]\n");
+        return 2;
+    }
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    return options.numWriters > 0 ? bench(options) : watch(options);
+}
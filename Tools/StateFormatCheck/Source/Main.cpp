@@ -0,0 +1,116 @@
+#include <JuceHeader.h>
+#include "../../../Source/QStateFormat.h"
+
+namespace
+{
+    constexpr int NUM_BANDS = 8;
+    using State = BinaryState<NUM_BANDS>;
+    const std::array<juce::uint8, 148> VERSION_1_BLOB {
+        0x51, 0x53, 0x52, 0x42, 0x01, 0x00, 0x14, 0x00, 0x08, 0x00, 0x10, 0x00, 0x00, 0x00, 0x60, 0xc0,
+        0x01, 0x02, 0x01, 0x00, 0x00, 0x00, 0xc8, 0x42, 0x00, 0x00, 0x80, 0xc0, 0x00, 0x00, 0x00, 0x3f,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x43, 0x00, 0x00, 0x40, 0xc0, 0x00, 0x00, 0x40, 0x3f,
+        0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x96, 0x43, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x80, 0x3f,
+        0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0xc8, 0x43, 0x00, 0x00, 0x80, 0xbf, 0x00, 0x00, 0xa0, 0x3f,
+        0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0xfa, 0x43, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x3f,
+        0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x16, 0x44, 0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0xe0, 0x3f,
+        0x05, 0x01, 0x02, 0x00, 0x00, 0x00, 0x2f, 0x44, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x40,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x44, 0x00, 0x00, 0x40, 0x40, 0x00, 0x00, 0x10, 0x40,
+        0x01, 0x01, 0x01, 0x00
+    };
+    const std::array<juce::uint8, 148> VERSION_2_BLOB {
+        0x51, 0x53, 0x52, 0x42, 0x02, 0x00, 0x14, 0x00, 0x08, 0x00, 0x10, 0x00, 0x00, 0x00, 0x60, 0xc0,
+        0x01, 0x02, 0x01, 0x01, 0x00, 0x00, 0xc8, 0x42, 0x00, 0x00, 0x80, 0xc0, 0x00, 0x00, 0x00, 0x3f,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x43, 0x00, 0x00, 0x40, 0xc0, 0x00, 0x00, 0x40, 0x3f,
+        0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x96, 0x43, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x80, 0x3f,
+        0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0xc8, 0x43, 0x00, 0x00, 0x80, 0xbf, 0x00, 0x00, 0xa0, 0x3f,
+        0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0xfa, 0x43, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x3f,
+        0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x16, 0x44, 0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0xe0, 0x3f,
+        0x05, 0x01, 0x02, 0x00, 0x00, 0x00, 0x2f, 0x44, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x40,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x44, 0x00, 0x00, 0x40, 0x40, 0x00, 0x00, 0x10, 0x40,
+        0x01, 0x01, 0x01, 0x00
+    };
+    const std::array<juce::uint8, 148> VERSION_3_BLOB {
+        0x51, 0x53, 0x52, 0x42, 0x03, 0x00, 0x14, 0x00, 0x08, 0x00, 0x10, 0x00, 0x00, 0x00, 0x60, 0xc0,
+        0x01, 0x02, 0x01, 0x01, 0x00, 0x00, 0xc8, 0x42, 0x00, 0x00, 0x80, 0xc0, 0x00, 0x00, 0x00, 0x3f,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x43, 0x00, 0x00, 0x40, 0xc0, 0x00, 0x00, 0x40, 0x3f,
+        0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x96, 0x43, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x80, 0x3f,
+        0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0xc8, 0x43, 0x00, 0x00, 0x80, 0xbf, 0x00, 0x00, 0xa0, 0x3f,
+        0x03, 0x01, 0x00, 0x01, 0x00, 0x00, 0xfa, 0x43, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x3f,
+        0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x16, 0x44, 0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0xe0, 0x3f,
+        0x05, 0x01, 0x02, 0x01, 0x00, 0x00, 0x2f, 0x44, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x40,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x44, 0x00, 0x00, 0x40, 0x40, 0x00, 0x00, 0x10, 0x40,
+        0x01, 0x01, 0x01, 0x01
+    };
+    struct Check
+    {
+        int failures = 0;
+        void expect(bool condition, int version, const char* what)
+        {
+            if (!condition)
+            {
+                std::printf("version %d: %s\n", version, what);
+                ++failures;
+            }
+        }
+    };
+    State makeDefaults()
+    {
+        State state;
+        for (auto& band : state.bands)
+        {
+            band.slope = 2;
+            band.ratio = 2.0f;
+            band.threshold = -18.0f;
+        }
+        return state;
+    }
+    bool isEqual(const State& a, const State& b)
+    {
+        if (a.outGain != b.outGain || a.bypass != b.bypass || a.analyzerTap != b.analyzerTap || a.idleSleep != b.idleSleep || a.snapshotFade != b.snapshotFade)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.bands.size(); ++i)
+        {
+            const auto& x = a.bands[i];
+            const auto& y = b.bands[i];
+            if (x.freq != y.freq || x.gain != y.gain || x.q != y.q || x.type != y.type || x.bypass != y.bypass || x.route != y.route || x.topology != y.topology || x.dynamic != y.dynamic || x.slope != y.slope || x.threshold != y.threshold || x.ratio != y.ratio || x.attack != y.attack || x.release != y.release)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    template <size_t Size>
+    void checkLegacy(Check& check, int version, const std::array<juce::uint8, Size>& blob)
+    {
+        auto state = makeDefaults();
+        check.expect(State::isBinaryState(blob.data(), static_cast<int>(blob.size())), version, "not recognised as binary state");
+        check.expect(state.read(blob.data(), static_cast<int>(blob.size())), version, "read failed");
+        check.expect(state.outGain == -3.5f && state.bypass == 1 && state.analyzerTap == 2 && state.idleSleep == 1, version, "header fields differ");
+        check.expect(state.snapshotFade == (version >= 2 ? 1 : 0), version, "snapshot fade differs");
+        for (int i = 0; i < NUM_BANDS; ++i)
+        {
+            const auto& band = state.bands[static_cast<size_t>(i)];
+            check.expect(band.freq == 100.0f * static_cast<float>(i + 1) && band.gain == static_cast<float>(i - 4) && band.q == 0.5f + 0.25f * static_cast<float>(i), version, "band shape differs");
+            check.expect(band.type == i % 6 && band.bypass == i % 2 && band.route == i % 3, version, "band switches differ");
+            check.expect(band.topology == (version >= 3 ? i % 2 : 0), version, "band topology differs");
+            check.expect(band.slope == 2 && band.ratio == 2.0f && band.threshold == -18.0f && band.dynamic == 0, version, "fields absent from this version were overwritten");
+        }
+        juce::MemoryBlock written;
+        state.write(written);
+        auto reloaded = makeDefaults();
+        check.expect(reloaded.read(written.getData(), static_cast<int>(written.getSize())), version, "re-read of current format failed");
+        check.expect(isEqual(state, reloaded), version, "current format round trip differs");
+        check.expect(!makeDefaults().read(blob.data(), static_cast<int>(blob.size()) - 1), version, "truncated blob accepted");
+    }
+}
+int main()
+{
+    Check check;
+    checkLegacy(check, 1, VERSION_1_BLOB);
+    checkLegacy(check, 2, VERSION_2_BLOB);
+    checkLegacy(check, 3, VERSION_3_BLOB);
+    std::printf("%s: %d failures\n", check.failures == 0 ? "passed" : "failed", check.failures);
+    return check.failures == 0 ? 0 : 1;
+}